@@ -67,6 +67,8 @@ extern "C"
 # define OK 0
 #endif
 
+#define PDC_WOULDBLOCK (-2)  /* from wgetch_r() and friends: try later */
+
 /*----------------------------------------------------------------------
  *
  *  PDCurses Type Declarations
@@ -196,7 +198,8 @@ typedef unsigned long mmask_t;
 typedef struct
 {
         short id;       /* unused, always 0 */
-        int x, y, z;    /* x, y same as MOUSE_STATUS; z unused */
+        int x, y, z;    /* x, y same as MOUSE_STATUS; z is the number
+                           of wheel notches merged into the event */
         mmask_t bstate; /* equivalent to changes + button[], but
                            in the same format as used for mousemask() */
 } MEVENT;
@@ -223,9 +226,42 @@ typedef struct
 typedef struct _win WINDOW;
 typedef struct _screen SCREEN;
 typedef struct _session SESSION;
+typedef struct _sched SCHED;
+typedef struct _reactor REACTOR;
+
+typedef struct
+{
+    void (*key)(SESSION *, int, void *);
+    void (*resize)(SESSION *, void *);
+    void (*timer)(SESSION *, void *);
+    void (*closed)(SESSION *, void *);
+} REACTOR_OPS;
+
+#define PDC_STATS_BUCKETS 20   /* doupdate() time histogram; see below */
+
+typedef struct
+{
+    unsigned long cells_written;  /* cells written to windows */
+    unsigned long refreshes;      /* wnoutrefresh() calls */
+    unsigned long cells_compared; /* by wnoutrefresh(), against curscr */
+    unsigned long cells_copied;   /* by wnoutrefresh(), to curscr */
+    unsigned long updates;        /* doupdate() calls */
+    unsigned long rows_sent;      /* rows drawn by doupdate() */
+    unsigned long cells_sent;
+    unsigned long panel_maps;     /* panel map recomputations */
+    unsigned long allocs;         /* blocks allocated for the session */
+    unsigned long alloc_bytes;    /* their bytes; see session_memory() */
+    unsigned long update_time[PDC_STATS_BUCKETS];
+                                  /* doupdate() calls by time taken:
+                                     [0] under 1 us, [i] under 2^i us,
+                                     the last one the rest */
+    unsigned long input_latency[PDC_STATS_BUCKETS];
+                                  /* doupdate() calls that followed
+                                     input, by the time from the
+                                     arrival of the oldest of it to
+                                     their end; buckets as above */
+} SESSION_STATS;
 
-extern int COLORS;
-extern int COLOR_PAIRS;
 
 
 /*----------------------------------------------------------------------
@@ -368,6 +404,9 @@ int     mvwscanw(SESSION *S, WINDOW *, int, int, const char *, ...);
 int     mvwvline(SESSION *S, WINDOW *, int, int, chtype, int);
 int     napms(SESSION *S, int);
 WINDOW *newpad(SESSION *S, int, int);
+WINDOW *newringpad(SESSION *S, int, int);
+WINDOW *newvpad(SESSION *S, int, int, int,
+                void (*)(SESSION *, WINDOW *, int, chtype *, void *), void *);
 SCREEN *newterm(SESSION *S, const char *, FILE *, FILE *, void *userargs);
 WINDOW *newwin(SESSION *S, int, int, int, int);
 int     nl(SESSION *S);
@@ -512,7 +551,8 @@ int     getparx(WINDOW *);
 int     getpary(WINDOW *);
 int     getcurx(WINDOW *);
 int     getcury(WINDOW *);
-char   *unctrl(chtype);
+char   *unctrl(SESSION *, chtype);
+char   *unctrl_r(chtype, char *);
 
 int     crmode(SESSION *);
 int     nocrmode(SESSION *);
@@ -543,6 +583,9 @@ int     mouseinterval(SESSION *S, int);
 mmask_t mousemask(SESSION *S, mmask_t, mmask_t *);
 bool    mouse_trafo(SESSION *S, int *, int *, bool);
 int     nc_getmouse(SESSION *S, MEVENT *);
+int     nc_getmouse_all(SESSION *S, MEVENT *, int);
+int     get_escdelay(SESSION *S);
+int     set_escdelay(SESSION *S, int);
 int     ungetmouse(SESSION *S, MEVENT *);
 bool    wenclose(const WINDOW *, int, int);
 bool    wmouse_trafo(const WINDOW *, int *, int *, bool);
@@ -550,7 +593,9 @@ bool    wmouse_trafo(const WINDOW *, int *, int *, bool);
 /* PDCurses */
 
 int     addrawch(SESSION *, chtype);
+int     add_timer(SESSION *, int, int (*)(SESSION *, void *), void *);
 int     insrawch(SESSION *, chtype);
+int     del_timer(SESSION *, int);
 bool    is_termresized(SESSION *);
 int     mvaddrawch(SESSION *, int, int, chtype);
 int     mvdeleteln(SESSION *, int, int);
@@ -559,11 +604,49 @@ int     mvinsrawch(SESSION *, int, int, chtype);
 int     mvwaddrawch(SESSION *, WINDOW *, int, int, chtype);
 int     mvwdeleteln(SESSION *, WINDOW *, int, int);
 int     mvwinsertln(SESSION *, WINDOW *, int, int);
+int     get_paste(SESSION *, char *, int);
+int     keyring_push(SESSION *, int, bool);
 int     mvwinsrawch(SESSION *, WINDOW *, int, int, chtype);
+int     doupdate_threads(SESSION *, int);
 int     raw_output(SESSION *, bool);
+int     reactor_add(REACTOR *, SESSION *, WINDOW *, const REACTOR_OPS *,
+                    void *);
+void    reactor_free(REACTOR *);
+REACTOR *reactor_new(void);
+int     reactor_post(REACTOR *, SESSION *);
+int     reactor_remove(REACTOR *, SESSION *);
+int     reactor_run(REACTOR *, int);
+int     reactor_timer(REACTOR *, SESSION *, int);
+int     ringpad_addline(SESSION *, WINDOW *, const char *);
+int     ringpad_follow(SESSION *, WINDOW *, bool);
+int     ringpad_newline(SESSION *, WINDOW *);
 int     resize_term(SESSION *, int, int);
 WINDOW *resize_window(SESSION *, WINDOW *, int, int);
+int     sched_add(SCHED *, SESSION *, void (*)(SESSION *, void *), void *);
+int     sched_drain(SCHED *);
+void    sched_free(SCHED *);
+SCHED  *sched_new(int);
+int     sched_post(SCHED *, SESSION *);
+int     sched_remove(SCHED *, SESSION *);
+int     session_stats(SESSION *, SESSION_STATS *);
+int     session_stats_dump(SESSION *, FILE *);
+int     session_stats_reset(SESSION *);
+unsigned long session_latency(SESSION *, int);
+unsigned long session_memory(SESSION *);
+int     session_memory_limit(SESSION *, unsigned long, unsigned long);
+int     trace_decode(FILE *, FILE *);
+int     trace_dump(SESSION *, FILE *);
+int     trace_start(SESSION *, int);
+int     trace_stop(SESSION *);
+int     vpad_invalidate(SESSION *, WINDOW *, int, int);
+int     vpad_set_rows(SESSION *, WINDOW *, int);
 int     waddrawch(SESSION *, WINDOW *, chtype);
+int     wgetch_batch(SESSION *, WINDOW *, int *, int, int);
+int     wgetch_r(SESSION *, WINDOW *, int *);
+int     wgetch_wake(SESSION *);
+int     wgetnstr_r(SESSION *, WINDOW *, char *, int, int *);
+int     wscanw_r(SESSION *, WINDOW *, int *, const char *, ...);
+int     vw_scanw_r(SESSION *, WINDOW *, int *, const char *, va_list);
 int     winsrawch(SESSION *, WINDOW *, chtype);
 char    wordchar(SESSION *);
 
@@ -579,10 +662,15 @@ int     PDC_freeclipboard(SESSION *S, char *);
 int     PDC_getclipboard(SESSION *S, char **, long *);
 int     PDC_setclipboard(SESSION *S, const char *, long);
 
+int     PDC_advance_clock(SESSION *, int);
+unsigned long PDC_get_clock(SESSION *);
 unsigned long PDC_get_input_fd(SESSION *S);
 unsigned long PDC_get_key_modifiers(SESSION *S);
+unsigned long PDC_get_key_time(SESSION *S);
 int     PDC_return_key_modifiers(SESSION *, bool);
+int     PDC_return_paste(SESSION *, bool);
 int     PDC_save_key_modifiers(SESSION *, bool);
+int     PDC_set_clock(SESSION *, bool);
 
 
 
@@ -611,6 +699,8 @@ int     PDC_save_key_modifiers(SESSION *, bool);
 #endif
 
 extern int LINES(SESSION *);
+extern int COLORS(SESSION *);
+extern int COLOR_PAIRS(SESSION *);
 extern int COLS(SESSION *);
 extern WINDOW* stdscr(SESSION *);
 extern MOUSE_STATUS *Mouse_status(SESSION *);
@@ -33,6 +33,13 @@ typedef struct panel
     struct panel *above;
     const void *user;
     struct panelobs *obscure;
+    bool is_static;             /* contents rarely change; see below */
+    unsigned long content_gen;  /* bumped when the window is redrawn */
+    unsigned long geom_gen;     /* bumped on move, replace and relink */
+    unsigned long layer_content;/* generations the layer was taken at */
+    unsigned long layer_geom;
+    chtype *layer;              /* cached cells of a static panel */
+    int layer_lines, layer_cols;/* the window's size when taken */
 } PANEL;
 
 int     bottom_panel(SESSION *S, PANEL *pan);
@@ -41,11 +48,14 @@ int     hide_panel(SESSION *S, PANEL *pan);
 int     move_panel(SESSION *S, PANEL *pan, int starty, int startx);
 PANEL  *new_panel(SESSION *S, WINDOW *win);
 PANEL  *panel_above(SESSION *S, const PANEL *pan);
+PANEL  *panel_at(SESSION *S, int *y, int *x);
 PANEL  *panel_below(SESSION *S, const PANEL *pan);
 int     panel_hidden(SESSION *S, const PANEL *pan);
+bool    panel_static(const PANEL *pan);
 const void *panel_userptr(const PANEL *pan);
 WINDOW *panel_window(const PANEL *pan);
 int     replace_panel(SESSION *S, PANEL *pan, WINDOW *win);
+int     set_panel_static(SESSION *S, PANEL *pan, bool flag);
 int     set_panel_userptr(PANEL *pan, const void *uptr);
 int     show_panel(SESSION *S, PANEL *pan);
 int     top_panel(SESSION *S, PANEL *pan);
@@ -120,7 +120,7 @@ int waddch(SESSION *S, WINDOW *win, const chtype ch)
     PDC_LOG(("waddch() - called: win=%p ch=%x (text=%c attr=0x%x)\n",
              win, ch, ch & A_CHARTEXT, ch & A_ATTRIBUTES));
 
-    if (!S || !win)
+    if (!S || !win || (win->_flags & _VPAD))
         return ERR;
 
     x = win->_curx;
@@ -239,6 +239,7 @@ int waddch(SESSION *S, WINDOW *win, const chtype ch)
                         win->_lastch[y] = x;
 
             win->_y[y][x] = text;
+            S->stats.cells_written++;
         }
 
         if (++x >= win->_maxx)
@@ -72,13 +72,15 @@ int waddchnstr(SESSION *S, WINDOW *win, const chtype *ch, int n)
 
     PDC_LOG(("waddchnstr() - called: win=%p n=%d\n", win, n));
 
-    if (!S || !win || !ch || !n || n < -1)
+    if (!S || !win || !ch || !n || n < -1 || (win->_flags & _VPAD))
         return ERR;
 
     x = win->_curx;
     y = win->_cury;
     ptr = &(win->_y[y][x]);
 
+    PDC_TRACE(S, PDC_TR_WADDCHNSTR, win, y, x, n);
+
     if (n == -1 || n > win->_maxx - x)
         n = win->_maxx - x;
 
@@ -101,6 +103,7 @@ int waddchnstr(SESSION *S, WINDOW *win, const chtype *ch, int n)
                      win->_firstch[y], win->_lastch[y]));
 
             *ptr = *ch;
+            S->stats.cells_written++;
         }
     }
 
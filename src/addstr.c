@@ -70,6 +70,8 @@ int waddnstr(SESSION *S, WINDOW *win, const char *str, int n)
     if (!S || !win || !str)
         return ERR;
 
+    PDC_TRACE(S, PDC_TR_WADDNSTR, win, win->_cury, win->_curx, n);
+
     while (str[i] && (i < n || n < 0))
     {
         chtype wch = (unsigned char)(str[i++]);
@@ -295,7 +295,7 @@ int wchgat(SESSION *S, WINDOW *win, int n, attr_t attr, short color, const void
 
     PDC_LOG(("wchgat() - called\n"));
 
-    if (!S || !win)
+    if (!S || !win || (win->_flags & _VPAD))
         return ERR;
 
     newattr = (attr & A_ATTRIBUTES) | COLOR_PAIR(color);
@@ -307,6 +307,8 @@ int wchgat(SESSION *S, WINDOW *win, int n, attr_t attr, short color, const void
     for (n = startpos; n <= endpos; n++)
         dest[n] = (dest[n] & A_CHARTEXT) | newattr;
 
+    S->stats.cells_written += endpos - startpos + 1;
+
     n = win->_cury;
 
     if (startpos < win->_firstch[n] || win->_firstch[n] == _NO_CHANGE)
@@ -17,8 +17,15 @@ RCSID("$Id: beep.c,v 1.34 2008/07/13 16:08:17 wmcbrine Exp $")
         if not, it calls flash().
 
         flash() "flashes" the screen, by inverting the foreground and
-        background of every cell, pausing, and then restoring the
-        original attributes.
+        background of every cell, and restoring them PDC_FLASH_MS
+        (50) milliseconds later. It doesn't wait for that: the restore
+        is a timer (see add_timer()), run by wgetch(), or by the first
+        doupdate() after it's due. Where the platform can, the terminal
+        reverses the screen by itself, and nothing is redrawn;
+        otherwise the cells are reversed, and sent as any other update.
+        Output to the screen while the flash shows ends it; where the
+        cells are reversed, so does any wnoutrefresh(), pnoutrefresh()
+        or update_panels(). A flash while one shows does nothing.
 
   Return Value:
         These functions return OK.
@@ -44,27 +51,90 @@ int beep(SESSION *S)
     return OK;
 }
 
-int flash(SESSION *S)
+/* Reverse each cell of curscr, marking it changed, so that doupdate()
+   sends it like any other change rather than redrawing everything */
+
+static void _reverse(SESSION *S)
+{
+    int y, x;
+
+    for (y = 0; y < S->curscr->_maxy; y++)
+    {
+        for (x = 0; x < S->curscr->_maxx; x++)
+            S->curscr->_y[y][x] ^= A_REVERSE;
+
+        S->curscr->_firstch[y] = 0;
+        S->curscr->_lastch[y] = S->curscr->_maxx - 1;
+    }
+}
+
+/* Restore the screen. Called by the timer, by doupdate() once the
+   flash is due to end, and before anything else is put in curscr. */
+
+void PDC_flash_end(SESSION *S)
+{
+    int state = S->flash_state;
+
+    if (!state)
+        return;
+
+    S->flash_state = PDC_FLASH_OFF;
+
+    if (S->flash_timer)
+    {
+        del_timer(S, S->flash_timer);
+        S->flash_timer = 0;
+    }
+
+    if (state == PDC_FLASH_TERM)
+        PDC_flash(S, FALSE);
+    else
+        _reverse(S);
+}
+
+static int _flash_timer(SESSION *S, void *arg)
 {
-    int z, y, x;
+    (void)arg;
+
+    S->flash_timer = 0;     /* being run, so it can't be deleted */
+
+    PDC_flash_end(S);
+
+    return 0;
+}
 
+int flash(SESSION *S)
+{
     PDC_LOG(("flash() - called\n"));
 
     if (!S)
         return ERR;
 
-    /* Reverse each cell; wait; restore the screen */
+    if (S->flash_state)
+        return OK;
 
-    for (z = 0; z < 2; z++)
+    if (PDC_flash(S, TRUE) == OK)
+        S->flash_state = PDC_FLASH_TERM;
+    else
     {
-        for (y = 0; y < S->LINES; y++)
-            for (x = 0; x < S->COLS; x++)
-                S->curscr->_y[y][x] ^= A_REVERSE;
+        _reverse(S);
+        S->flash_state = PDC_FLASH_CELLS;
+
+        doupdate(S);
+    }
+
+    S->flash_until = PDC_get_clock(S) + PDC_FLASH_MS;
+    S->flash_timer = add_timer(S, PDC_FLASH_MS, _flash_timer, NULL);
 
-        wrefresh(S, S->curscr);
+    /* no timer, so wait, as before */
+
+    if (S->flash_timer == ERR)
+    {
+        S->flash_timer = 0;
+        napms(S, PDC_FLASH_MS);
 
-        if (!z)
-            napms(S, 50);
+        PDC_flash_end(S);
+        doupdate(S);
     }
 
     return OK;
@@ -66,7 +66,7 @@ int wbkgd(SESSION *S, WINDOW *win, chtype ch)
 
     PDC_LOG(("wbkgd() - called\n"));
 
-    if (!S || !win)
+    if (!S || !win || (win->_flags & _VPAD))
         return ERR;
 
     if (win->_bkgd == ch)
@@ -130,6 +130,8 @@ int wbkgd(SESSION *S, WINDOW *win, chtype ch)
         }
     }
 
+    S->stats.cells_written += (unsigned long)win->_maxy * win->_maxx;
+
     touchwin(S, win);
     PDC_sync(S, win);
     return OK;
@@ -135,7 +135,7 @@ int wborder(SESSION *S, WINDOW *win, chtype ls, chtype rs, chtype ts, chtype bs,
 
     PDC_LOG(("wborder() - called\n"));
 
-    if (!S || !win)
+    if (!S || !win || (win->_flags & _VPAD))
         return ERR;
 
     ymax = win->_maxy - 1;
@@ -167,6 +167,8 @@ int wborder(SESSION *S, WINDOW *win, chtype ls, chtype rs, chtype ts, chtype bs,
     win->_y[ymax][0] = bl;
     win->_y[ymax][xmax] = br;
 
+    S->stats.cells_written += 2 * (xmax + ymax);
+
     for (i = 0; i <= ymax; i++)
     {
         win->_firstch[i] = 0;
@@ -200,7 +202,7 @@ int whline(SESSION *S, WINDOW *win, chtype ch, int n)
 
     PDC_LOG(("whline() - called\n"));
 
-    if (!S || !win || n < 1)
+    if (!S || !win || n < 1 || (win->_flags & _VPAD))
         return ERR;
 
     startpos = win->_curx;
@@ -211,6 +213,8 @@ int whline(SESSION *S, WINDOW *win, chtype ch, int n)
     for (n = startpos; n <= endpos; n++)
         dest[n] = ch;
 
+    S->stats.cells_written += endpos - startpos + 1;
+
     n = win->_cury;
 
     if (startpos < win->_firstch[n] || win->_firstch[n] == _NO_CHANGE)
@@ -257,7 +261,7 @@ int wvline(SESSION *S, WINDOW *win, chtype ch, int n)
 
     PDC_LOG(("wvline() - called\n"));
 
-    if (!S || !win || n < 1)
+    if (!S || !win || n < 1 || (win->_flags & _VPAD))
         return ERR;
 
     endpos = min(win->_cury + n, win->_maxy);
@@ -265,6 +269,8 @@ int wvline(SESSION *S, WINDOW *win, chtype ch, int n)
 
     ch = _attr_passthru(win, ch ? ch : ACS_VLINE);
 
+    S->stats.cells_written += endpos - win->_cury;
+
     for (n = win->_cury; n < endpos; n++)
     {
         win->_y[n][x] = ch;
@@ -55,7 +55,7 @@ int wclrtoeol(SESSION *S, WINDOW *win)
     PDC_LOG(("wclrtoeol() - called: Row: %d Col: %d\n",
              win->_cury, win->_curx));
 
-    if (!S || !win)
+    if (!S || !win || (win->_flags & _VPAD))
         return ERR;
 
     y = win->_cury;
@@ -68,6 +68,8 @@ int wclrtoeol(SESSION *S, WINDOW *win)
     for (minx = x, ptr = &win->_y[y][x]; minx < win->_maxx; minx++, ptr++)
         *ptr = blank;
 
+    S->stats.cells_written += win->_maxx - x;
+
     if (x < win->_firstch[y] || win->_firstch[y] == _NO_CHANGE)
         win->_firstch[y] = x;
 
@@ -91,7 +93,7 @@ int wclrtobot(SESSION *S, WINDOW *win)
 
     PDC_LOG(("wclrtobot() - called\n"));
 
-    if (!S || !win)
+    if (!S || !win || (win->_flags & _VPAD))
         return ERR;
 
     /* should this involve scrolling region somehow ? */
@@ -125,6 +127,8 @@ int werase(SESSION *S, WINDOW *win)
     if (wmove(S, win, 0, 0) == ERR)
         return ERR;
 
+    PDC_TRACE(S, PDC_TR_WERASE, win, 0, 0, 0);
+
     return wclrtobot(S, win);
 }
 
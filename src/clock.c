@@ -0,0 +1,108 @@
+/* Public Domain Curses */
+
+#include "curspriv.h"
+
+RCSID("$Id: clock.c,v 1.1 $")
+
+/*man-start**************************************************************
+
+  Name:                                                         clock
+
+  Synopsis:
+        int PDC_set_clock(SESSION *S, bool virtual_time);
+        int PDC_advance_clock(SESSION *S, int ms);
+        unsigned long PDC_get_clock(SESSION *S);
+
+  Description:
+        Every delay and timeout in a session is measured by its clock:
+        napms() and delay_output(), the flash() of the screen, the
+        timeouts of wgetch() set by timeout(), wtimeout() and
+        halfdelay(), the escape delay, the timers of add_timer(), and
+        the time a key is reported to have come. The clock is
+        normally the platform's real time.
+
+        PDC_set_clock() with virtual_time TRUE gives S a virtual clock,
+        starting from the real time, for simulations and tests. It
+        stands still but for PDC_advance_clock(), and for the delays
+        themselves: napms() just moves it on by its argument, and when
+        wgetch() would wait for a key with a timeout (or a timer), and
+        none is ready, it moves the clock to the end of the wait at
+        once and carries on as if it had waited. A script can so run a
+        session as fast as it can be drawn, with the same results every
+        time. Only a wait with no limit still blocks for real input.
+        With FALSE, PDC_set_clock() returns S to real time; that should
+        be done only while no timeout or timer is pending.
+
+        PDC_advance_clock() moves a virtual clock on by ms
+        milliseconds. PDC_get_clock() returns the time in milliseconds
+        by the clock of S; platforms use it to time input.
+
+  Return Value:
+        PDC_advance_clock() returns ERR if the clock of S is real, or ms
+        is negative. PDC_set_clock() returns OK, or ERR if S is NULL.
+
+  Portability                                X/Open    BSD    SYS V
+        PDC_set_clock                           -       -       -
+        PDC_advance_clock                       -       -       -
+        PDC_get_clock                           -       -       -
+
+**man-end****************************************************************/
+
+int PDC_set_clock(SESSION *S, bool virtual_time)
+{
+    PDC_LOG(("PDC_set_clock() - called: virtual %d\n", virtual_time));
+
+    if (!S)
+        return ERR;
+
+    if (virtual_time && !S->clock_virtual)
+        S->clock_now = PDC_ms_clock(S);
+
+    S->clock_virtual = virtual_time;
+
+    return OK;
+}
+
+int PDC_advance_clock(SESSION *S, int ms)
+{
+    PDC_LOG(("PDC_advance_clock() - called: ms %d\n", ms));
+
+    if (!S || !S->clock_virtual || ms < 0)
+        return ERR;
+
+    S->clock_now += ms;
+
+    return OK;
+}
+
+unsigned long PDC_get_clock(SESSION *S)
+{
+    if (S && S->clock_virtual)
+        return S->clock_now;
+
+    return PDC_ms_clock(S);
+}
+
+/* napms() */
+
+void PDC_clock_sleep(SESSION *S, int ms)
+{
+    if (S && S->clock_virtual)
+        S->clock_now += ms;
+    else
+        PDC_napms(S, ms);
+}
+
+/* The wait in wgetch(), when no key is ready: on a virtual clock, a
+   wait with a limit is over at once */
+
+int PDC_clock_wait(SESSION *S, int ms)
+{
+    if (S->clock_virtual && ms >= 0)
+    {
+        S->clock_now += ms;
+        return PDC_WAIT_TIMEOUT;
+    }
+
+    return PDC_wait_key(S, ms);
+}
@@ -22,6 +22,9 @@ RCSID("$Id: color.c,v 1.83 2008/07/13 16:08:18 wmcbrine Exp $")
 
         int PDC_set_line_color(short color);
 
+        int COLORS(SESSION *S);
+        int COLOR_PAIRS(SESSION *S);
+
   Description:
         To use these routines, start_color() must be called, usually
         immediately after initscr(). Colors are always used in pairs,
@@ -31,10 +34,11 @@ RCSID("$Id: color.c,v 1.83 2008/07/13 16:08:18 wmcbrine Exp $")
         can be used like any other video attribute.
 
         start_color() initializes eight basic colors (black, red, green,
-        yellow, blue, magenta, cyan, and white), and two global
-        variables; COLORS and COLOR_PAIRS (respectively defining the
+        yellow, blue, magenta, cyan, and white), and sets the values
+        returned by COLORS() and COLOR_PAIRS() (respectively the
         maximum number of colors and color-pairs the terminal is capable
-        of displaying).
+        of displaying). Like all color state, these are kept per
+        session.
 
         init_pair() changes the definition of a color-pair. It takes
         three arguments: the number of the color-pair to be redefined,
@@ -88,22 +92,14 @@ RCSID("$Id: color.c,v 1.83 2008/07/13 16:08:18 wmcbrine Exp $")
         assume_default_colors                   -       -       -
         use_default_colors                      -       -       -
         PDC_set_line_color                      -       -       -
+        COLORS                                  -       -       -
+        COLOR_PAIRS                             -       -       -
 
 **man-end****************************************************************/
 
 #include <stdbool.h>
 #include <string.h>
 
-int COLORS = 0;
-int COLOR_PAIRS = PDC_COLOR_PAIRS;
-
-
-/* pair_set[] tracks whether a pair has been set via init_pair() */
-
-static bool pair_set[PDC_COLOR_PAIRS];
-static bool default_colors = FALSE;
-static short first_col = 0;
-
 
 
 int start_color(SESSION *S)
@@ -120,12 +116,12 @@ int start_color(SESSION *S)
 
     PDC_set_blink(S, FALSE);   /* Also sets COLORS, to 8 or 16 */
 
-    if (!default_colors && S->SP->orig_attr)
-        default_colors = TRUE;
+    if (!S->default_colors && S->SP->orig_attr)
+        S->default_colors = TRUE;
 
     PDC_init_atrtab(S);
 
-    memset(pair_set, 0, PDC_COLOR_PAIRS);
+    memset(S->pair_set, 0, PDC_COLOR_PAIRS);
 
     return OK;
 }
@@ -146,8 +142,9 @@ int init_pair(SESSION *S, short pair, short fg, short bg)
     if (!S)
         return ERR;
 
-    if (!S->color_started || pair < 1 || pair >= COLOR_PAIRS ||
-        fg < first_col || fg >= COLORS || bg < first_col || bg >= COLORS)
+    if (!S->color_started || pair < 1 || pair >= S->COLOR_PAIRS ||
+        fg < S->first_col || fg >= S->COLORS ||
+        bg < S->first_col || bg >= S->COLORS)
         return ERR;
 
     _normalize(S, &fg, &bg);
@@ -156,7 +153,7 @@ int init_pair(SESSION *S, short pair, short fg, short bg)
        curscr if this call to init_pair() alters a color pair created by
        the user. */
 
-    if (pair_set[pair])
+    if (S->pair_set[pair])
     {
         short oldfg, oldbg;
 
@@ -168,7 +165,7 @@ int init_pair(SESSION *S, short pair, short fg, short bg)
 
     PDC_init_pair(S, pair, fg, bg);
 
-    pair_set[pair] = TRUE;
+    S->pair_set[pair] = TRUE;
 
     return OK;
 }
@@ -190,7 +187,7 @@ int init_color(SESSION *S, short color, short red, short green, short blue)
     if (!S)
         return ERR;
 
-    if (color < 0 || color >= COLORS || !PDC_can_change_color(S) ||
+    if (color < 0 || color >= S->COLORS || !PDC_can_change_color(S) ||
         red < 0 || red > 1000 || green < 0 || green > 1000 ||
         blue < 0 || blue > 1000)
         return ERR;
@@ -205,7 +202,7 @@ int color_content(SESSION *S, short color, short *red, short *green, short *blue
     if (!S)
         return ERR;
 
-    if (color < 0 || color >= COLORS || !red || !green || !blue)
+    if (color < 0 || color >= S->COLORS || !red || !green || !blue)
         return ERR;
 
     if (PDC_can_change_color(S))
@@ -236,7 +233,7 @@ int pair_content(SESSION *S, short pair, short *fg, short *bg)
 {
     PDC_LOG(("pair_content() - called\n"));
 
-    if (pair < 0 || pair >= COLOR_PAIRS || !fg || !bg)
+    if (pair < 0 || pair >= S->COLOR_PAIRS || !fg || !bg)
         return ERR;
 
     return PDC_pair_content(S, pair, fg, bg);
@@ -249,7 +246,7 @@ int assume_default_colors(SESSION *S, int f, int b)
     if (!S)
         return ERR;
 
-    if (f < -1 || f >= COLORS || b < -1 || b >= COLORS)
+    if (f < -1 || f >= S->COLORS || b < -1 || b >= S->COLORS)
         return ERR;
 
     if (S->color_started)
@@ -279,8 +276,8 @@ int use_default_colors(SESSION *S)
     if (!S)
         return ERR;
 
-    default_colors = TRUE;
-    first_col = -1;
+    S->default_colors = TRUE;
+    S->first_col = -1;
 
     return assume_default_colors(S, -1, -1);
 }
@@ -292,7 +289,7 @@ int PDC_set_line_color(SESSION *S, short color)
     if (!S)
         return ERR;
 
-    if (color < -1 || color >= COLORS)
+    if (color < -1 || color >= S->COLORS)
         return ERR;
 
     S->SP->line_color = color;
@@ -308,7 +305,7 @@ void PDC_init_atrtab(SESSION *S)
     if (!S)
         return;
 
-    if (S->color_started && !default_colors)
+    if (S->color_started && !S->default_colors)
     {
         fg = COLOR_WHITE;
         bg = COLOR_BLACK;
@@ -36,6 +36,13 @@
 
 #define _INBUFSIZ   512 /* size of terminal input buffer */
 #define NUNGETCH    256 /* max # chars to ungetch() */
+#define PDC_MOUSEQ_SIZE 16 /* mouse events held for nc_getmouse() */
+
+#ifdef CHTYPE_LONG
+# define PDC_COLOR_PAIRS 256
+#else
+# define PDC_COLOR_PAIRS  32
+#endif
 
 
 /*----------------------------------------------------------------------
@@ -76,6 +83,12 @@ struct _win       /* definition of a window */
     int   _delayms;       /* milliseconds of delay for getch() */
     int   _parx, _pary;   /* coords relative to parent (0,0) */
     struct _win *_parent; /* subwin's pointer to parent win */
+    int   _pady, _padx;   /* pad viewport of the last pnoutrefresh() */
+    int   _sminy, _sminx, _smaxy, _smaxx;
+    int   _ringhead;      /* ring pad: offset of the line arrays' view */
+    int   _ringshift;     /* ring pad: lines added since pnoutrefresh() */
+    bool  _follow;        /* ring pad: pnoutrefresh() shows the tail */
+    struct _vpad *_vpad;  /* virtual pad: dataset and line cache */
 };
 
 struct _screen
@@ -123,6 +136,18 @@ struct _screen
     short line_color;     /* color of line attributes - default -1 */
 };
 
+struct cttyset           /* tty modes saved by def_prog_mode() etc. */
+{
+    bool been_set;
+    SCREEN saved;
+};
+
+struct mouseev           /* a queued mouse event */
+{
+    MOUSE_STATUS status;
+    int ticks;           /* wheel notches merged into it */
+};
+
 struct _session
 {
     SCREEN      *SP;           /* curses variables */
@@ -136,24 +161,93 @@ struct _session
     char         linesrippedoff;
 
     bool         color_started;
+    int          COLORS;       /* set by PDC_set_blink() */
+    int          COLOR_PAIRS;
+    bool         pair_set[PDC_COLOR_PAIRS]; /* set via init_pair() */
+    bool         default_colors;
+    short        first_col;
+    struct cttyset ctty[3];    /* saved shell/program/resetty modes */
+    char         unctrl_buf[3];
     MOUSE_STATUS Mouse_status;
     MOUSE_STATUS mouse_status;
     bool         mouse_ungot;
+    struct mouseev mouseq[PDC_MOUSEQ_SIZE]; /* events not yet read */
+    int          mouseq_head;
+    int          mouseq_len;
+    int          mouseq_told;       /* of those, returned as KEY_MOUSE */
+    int          mouse_ticks;       /* of the event in Mouse_status */
+    bool         key_held;          /* a key read past a mouse burst */
+    bool         key_held_code;
+    int          key_held_key;
+    unsigned long key_held_arrival;
+    unsigned long key_arrival;      /* PDC_stats_usec() when the last
+                                       key read came in */
+    unsigned long input_since;      /* arrival of the oldest key read
+                                       since the last doupdate(), or 0 */
     unsigned long key_modifiers;
     int          getch_c_pindex;    /* putter index */
     int          getch_c_gindex;    /* getter index */
     int          getch_c_ungind;    /* ungetch() push index */
     int          getch_c_ungch[NUNGETCH];   /* array of ungotten chars */
     int          getch_buffer[_INBUFSIZ];   /* character buffer */
+    struct _keyring *keyring;       /* keys from keyring_push() */
+    struct _keydec *keydec;         /* escape sequence decoder */
+    int          escdelay;          /* see set_escdelay() */
+    unsigned long key_time;         /* see PDC_get_key_time() */
+    bool         clock_virtual;     /* see PDC_set_clock() */
+    unsigned long clock_now;        /* the virtual time */
+    struct _timer *timers;          /* see add_timer(); soonest first */
+    int          flash_state;       /* how flash() shows, if it does */
+    int          flash_timer;       /* its timer, to end it */
+    unsigned long flash_until;      /* PDC_get_clock() at its end */
+    int          timer_id;          /* id of the last timer added */
+    bool         getch_resume;      /* wgetch_r() returned PDC_WOULDBLOCK */
+    bool         getch_batch;       /* in wgetch_batch(): echo unrefreshed */
+    bool         typeahead;         /* doupdate() yields to input */
+    bool         echo_pending;      /* echo not yet refreshed */
+    char        *paste_buf;         /* text from PDC_paste_add() */
+    int          paste_len;
+    int          paste_pos;         /* next byte to hand out */
+    int          paste_size;
+    bool         paste_delivered;   /* returned as KEY_PASTE */
+    bool         return_paste;      /* see PDC_return_paste() */
+    unsigned long echo_since;       /* PDC_get_clock() of the first */
+    int          getch_delay;       /* ms to wait: -1 blocks */
+    unsigned long getch_deadline;   /* PDC_get_clock() at the timeout */
+    bool         getstr_active;     /* wgetnstr() line in progress */
+    bool         getstr_oldecho;
+    bool         getstr_oldcbreak;
+    bool         getstr_oldnodelay;
+    bool         getstr_oldpaste;
+    int          getstr_chars;
+    int          getstr_pos;
+    int          getstr_x;
+    char         scanw_buf[256];    /* line for wscanw_r() */
     int          pad_save_pminrow;
     int          pad_save_pmincol;
     int          pad_save_sminrow;
     int          pad_save_smincol;
     int          pad_save_smaxrow;
     int          pad_save_smaxcol;
+    int          scroll_hint_top;   /* curscr rows already shifted, */
+    int          scroll_hint_bot;   /* awaiting PDC_scroll() in */
+    int          scroll_hint_n;     /* doupdate() */
     PANEL       *panel_bottom;
     PANEL       *panel_top;
     PANEL        panel_stdscr_pseudo;
+    PANEL      **panel_map;    /* topmost panel for each screen cell */
+    int          panel_map_lines;
+    int          panel_map_cols;
+    bool         panel_map_stale;
+    struct _sched_ent *sched;  /* scheduler entry; see sched_add() */
+    struct _rowpar *rowpar;    /* doupdate() threads, if any */
+    struct _reactor_ent *reactor; /* see reactor_add() */
+    SESSION_STATS stats;       /* see session_stats() */
+    unsigned long mem_used;    /* see session_memory() */
+    unsigned long mem_soft;
+    unsigned long mem_hard;
+    struct _trace *trace;      /* see trace_start() */
+    bool         trace_on;
     struct SLK  *slk;
     int          slk_label_length;
     int          slk_labels;
@@ -173,6 +267,39 @@ extern chtype acs_map[];    /* alternate character set map */
 #define _SUBWIN    0x01  /* window is a subwindow */
 #define _PAD       0x10  /* X/Open Pad. */
 #define _SUBPAD    0x20  /* X/Open subpad. */
+#define _RINGPAD   0x40  /* pad whose lines form a ring; see newringpad() */
+#define _VPAD      0x80  /* pad whose lines are rendered; see newvpad() */
+
+/* PDC_wait_key() results: the time ran out, input may be ready, or
+   PDC_wake() was called */
+
+#define PDC_WAIT_TIMEOUT 0
+#define PDC_WAIT_INPUT   1
+#define PDC_WAIT_WOKEN   2
+
+/* flash() states: the terminal shows it, or curscr has been reversed */
+
+#define PDC_FLASH_OFF   0
+#define PDC_FLASH_TERM  1
+#define PDC_FLASH_CELLS 2
+
+/* trace points; see trace_start(), and the names in trace.c */
+
+#define PDC_TR_WMOVE         1
+#define PDC_TR_WADDNSTR      2
+#define PDC_TR_WADDCHNSTR    3
+#define PDC_TR_WERASE        4
+#define PDC_TR_WNOUTREFRESH  5
+#define PDC_TR_DOUPDATE      6
+#define PDC_TR_DOUPDATE_END  7
+#define PDC_TR_UPDATE_PANELS 8
+#define PDC_TR_WGETCH        9
+#define PDC_TR_WGETCH_BATCH 10
+#define PDC_TR_NAPMS        11
+
+#define PDC_TRACE(S, func, win, y, x, arg) \
+    do { if ((S) && (S)->trace_on) \
+             PDC_trace((S), (func), (win), (y), (x), (arg)); } while (0)
 
 /* Miscellaneous */
 
@@ -192,14 +319,18 @@ void    PDC_beep(SESSION *);
 bool    PDC_can_change_color(SESSION *);
 int     PDC_color_content(SESSION *, short, short *, short *, short *);
 bool    PDC_check_key(SESSION *);
+int     PDC_flash(SESSION *, bool);
 int     PDC_curs_set(SESSION *, int);
+int     PDC_flush(SESSION *);
 void    PDC_flushinp(SESSION *);
 int     PDC_get_cursor_mode(SESSION *);
 int     PDC_get_key(SESSION *);
+int     PDC_get_output_fd(SESSION *);
 void    PDC_get_termsize(SESSION *, int *, int *);
 void    PDC_gotoyx(SESSION *, int, int);
 int     PDC_init_color(SESSION *, short, short, short, short);
 void    PDC_init_pair(SESSION *, short, short, short);
+unsigned long PDC_ms_clock(SESSION *);
 int     PDC_modifiers_set(SESSION *);
 int     PDC_mouse_set(SESSION *);
 void    PDC_napms(SESSION *, int);
@@ -210,10 +341,17 @@ int     PDC_resize_screen(SESSION *, int, int);
 void    PDC_restore_screen_mode(SESSION *, int);
 void    PDC_save_screen_mode(SESSION *, int);
 void    PDC_scr_close(SESSION *);
+void    PDC_seg_close(SESSION *, void *);
+void    PDC_seg_flush(SESSION *, void *);
+void    PDC_seg_line(SESSION *, void *, int, int, int, const chtype *);
+void   *PDC_seg_open(SESSION *);
+int     PDC_scroll(SESSION *, int, int, int);
 void    PDC_scr_free(SESSION *);
 int     PDC_scr_open(SESSION *, void *userargs);
 void    PDC_set_keyboard_binary(SESSION *, bool);
 void    PDC_transform_line(SESSION *, int, int, int, const chtype *);
+int     PDC_wait_key(SESSION *, int);
+int     PDC_wake(SESSION *);
 const char *PDC_sysname(SESSION *);
 void   *PDC_malloc(unsigned);
 void   *PDC_calloc(unsigned, unsigned);
@@ -222,13 +360,52 @@ void    PDC_free(void *);
 
 /* Internal cross-module functions */
 
+void    PDC_clock_sleep(SESSION *, int);
+int     PDC_clock_wait(SESSION *, int);
+bool    PDC_defer_refresh(SESSION *);
+void    PDC_flash_end(SESSION *);
 void    PDC_init_atrtab(SESSION *);
+bool    PDC_input_pending(SESSION *);
+void    PDC_keyring_awake(SESSION *);
+void    PDC_keyring_flush(SESSION *);
+void    PDC_keyring_free(SESSION *);
+int     PDC_keyring_init(SESSION *);
+int     PDC_keydec_expire(SESSION *, unsigned long);
+int     PDC_keydec_feed(SESSION *, const char *, int, unsigned long);
+void    PDC_keydec_flush(SESSION *);
+void    PDC_keydec_free(SESSION *);
+bool    PDC_keydec_get(SESSION *, int *);
+int     PDC_keydec_init(SESSION *);
+bool    PDC_keydec_pending(SESSION *);
+bool    PDC_keyring_pending(SESSION *);
+bool    PDC_keyring_pop(SESSION *, int *);
+bool    PDC_keyring_sleep(SESSION *);
+int     PDC_keyring_wake(SESSION *);
+bool    PDC_keyring_woken(SESSION *);
 WINDOW *PDC_makelines(SESSION *, WINDOW *);
 WINDOW *PDC_makenew(SESSION *, int, int, int, int);
+int     PDC_ring_advance(SESSION *, WINDOW *);
+bool    PDC_mem_full(SESSION *);
 int     PDC_mouse_in_slk(SESSION *, int, int);
+void    PDC_mouse_push(SESSION *);
+void    PDC_panel_free(SESSION *);
+int     PDC_paste_add(SESSION *, const char *, int);
+void    PDC_paste_free(SESSION *);
+void    PDC_rowpar_free(SESSION *);
+int     PDC_rowpar_update(SESSION *, bool);
+void   *PDC_scalloc(SESSION *, unsigned, unsigned);
+void    PDC_sfree(SESSION *, void *);
+void   *PDC_smalloc(SESSION *, unsigned);
 void    PDC_slk_free(SESSION *);
 void    PDC_slk_initialize(SESSION *);
+unsigned long PDC_stats_usec(void);
+void    PDC_stats_update(SESSION *, unsigned long, bool);
 void    PDC_sync(SESSION *, WINDOW *);
+void    PDC_trace(SESSION *, int, const WINDOW *, int, int, long);
+void    PDC_trace_free(SESSION *);
+void    PDC_timer_free(SESSION *);
+bool    PDC_timer_run(SESSION *);
+int     PDC_timer_wait(SESSION *, int);
 
 # define PDC_LOG(x)
 # define RCSID(x)
@@ -236,12 +413,6 @@ void    PDC_sync(SESSION *, WINDOW *);
 
 /* Internal macros for attributes */
 
-#ifdef CHTYPE_LONG
-# define PDC_COLOR_PAIRS 256
-#else
-# define PDC_COLOR_PAIRS  32
-#endif
-
 #ifndef max
 # define max(a,b) (((a) > (b)) ? (a) : (b))
 #endif
@@ -251,6 +422,16 @@ void    PDC_sync(SESSION *, WINDOW *);
 
 #define DIVROUND(num, divisor) ((num) + ((divisor) >> 1)) / (divisor)
 
+#define PDC_FLASH_MS      50  /* length of a flash() */
+
+#define PDC_TYPEAHEAD_ROWS 8  /* doupdate() lines between input checks */
+#define PDC_ECHO_DEFER_MS 30  /* longest an echo waits for a refresh */
+
+#define PDC_ESCDELAY     100  /* ms an ESC waits for the rest of a
+                                 sequence, if not set by set_escdelay() */
+
+#define PDC_MOUSE_AHEAD   64  /* mouse reports merged per KEY_MOUSE */
+
 #define PDC_CLICK_PERIOD 150  /* time to wait for a click, if
                                  not set by mouseinterval() */
 
@@ -41,7 +41,7 @@ int wdelch(SESSION *S, WINDOW *win)
 
     PDC_LOG(("wdelch() - called\n"));
 
-    if (!S || !win)
+    if (!S || !win || (win->_flags & _VPAD))
         return ERR;
 
     y = win->_cury;
@@ -54,6 +54,7 @@ int wdelch(SESSION *S, WINDOW *win)
     /* wrs (4/10/93) account for window background */
 
     win->_y[y][maxx] = win->_bkgd;
+    S->stats.cells_written += maxx - x + 1;
 
     win->_lastch[y] = maxx;
 
@@ -57,7 +57,7 @@ int wdeleteln(SESSION *S, WINDOW *win)
 
     PDC_LOG(("wdeleteln() - called\n"));
 
-    if (!win)
+    if (!S || !win || (win->_flags & _VPAD))
         return ERR;
 
     /* wrs (4/10/93) account for window background */
@@ -76,6 +76,11 @@ int wdeleteln(SESSION *S, WINDOW *win)
     for (ptr = temp; (ptr - temp < win->_maxx); ptr++)
         *ptr = blank;           /* make a blank line */
 
+    /* the lines moved up count as written, with the blank one */
+
+    S->stats.cells_written += (unsigned long)win->_maxx *
+                              (max(win->_bmarg - win->_cury, 0) + 1);
+
     if (win->_cury <= win->_bmarg)
     {
         win->_firstch[win->_bmarg] = 0;
@@ -153,7 +158,7 @@ int winsertln(SESSION *S, WINDOW *win)
 
     PDC_LOG(("winsertln() - called\n"));
 
-    if (!win)
+    if (!S || !win || (win->_flags & _VPAD))
         return ERR;
 
     /* wrs (4/10/93) account for window background */
@@ -174,6 +179,9 @@ int winsertln(SESSION *S, WINDOW *win)
     for (end = &temp[win->_maxx - 1]; temp <= end; temp++)
         *temp = blank;
 
+    S->stats.cells_written += (unsigned long)win->_maxx *
+                              (win->_maxy - win->_cury);
+
     win->_firstch[win->_cury] = 0;
     win->_lastch[win->_cury] = win->_maxx - 1;
 
@@ -15,6 +15,9 @@ RCSID("$Id: getch.c,v 1.72 2008/07/13 16:08:18 wmcbrine Exp $")
         int mvwgetch(WINDOW *win, int y, int x);
         int ungetch(int ch);
         int flushinp(void);
+        int wgetch_wake(void);
+        int wgetch_r(WINDOW *win, int *ms);
+        int wgetch_batch(WINDOW *win, int *keys, int max, int timeout_ms);
 
         int get_wch(wint_t *wch);
         int wget_wch(WINDOW *win, wint_t *wch);
@@ -26,6 +29,9 @@ RCSID("$Id: getch.c,v 1.72 2008/07/13 16:08:18 wmcbrine Exp $")
         int PDC_save_key_modifiers(bool flag);
         int PDC_return_key_modifiers(bool flag);
 
+        int PDC_return_paste(bool flag);
+        int get_paste(char *buf, int n);
+
   Description:
         With the getch(), wgetch(), mvgetch(), and mvwgetch() functions,
         a character is read from the terminal associated with the window.
@@ -36,6 +42,10 @@ RCSID("$Id: getch.c,v 1.72 2008/07/13 16:08:18 wmcbrine Exp $")
         newline.  Unless noecho() has been set, the character will also
         be echoed into the designated window.
 
+        While more input is already waiting, as when text is pasted,
+        the echo is not refreshed after every character, but once the
+        input runs out, or every few dozen milliseconds.
+
         If keypad() is TRUE, and a function key is pressed, the token for
         that function key will be returned instead of the raw characters.
         Possible function keys are defined in <curses.h> with integers
@@ -50,6 +60,29 @@ RCSID("$Id: getch.c,v 1.72 2008/07/13 16:08:18 wmcbrine Exp $")
         flushinp() throws away any type-ahead that has been typed by the
         user and has not yet been read by the program.
 
+        While waiting, wgetch() sleeps until input arrives or its
+        timeout expires, to the millisecond, rather than polling.
+        wgetch_wake() may be called from any thread to make a wgetch()
+        of the session that is waiting return ERR at once; if none is
+        waiting, the next one to wait does so.
+
+        wgetch_r() is a resumable wgetch() for servers that run many
+        sessions on one thread. Where wgetch() would sleep, it returns
+        PDC_WOULDBLOCK at once, and sets *ms (if ms is not NULL) to the
+        milliseconds left before the timeout, or -1 if there is none.
+        The caller should wait until the descriptor returned by
+        PDC_get_input_fd() is readable or *ms has passed, and then
+        call it again; the timeout and any partly-read line in cooked
+        mode carry over from one call to the next.
+
+        wgetch_batch() gets up to max keys in one call, so that a
+        burst of typing can be handled and then drawn once. It waits
+        up to timeout_ms milliseconds for the first key (-1 to wait
+        for ever, 0 not to wait), then takes only the keys that are
+        already waiting. The window is refreshed at most once before,
+        and, if keys were echoed, once after. A KEY_PASTE ends the
+        batch, so that get_paste() can still read its text.
+
         PDC_get_key_modifiers() returns the keyboard modifiers (shift,
         control, alt, numlock) effective at the time of the last getch()
         call, if PDC_save_key_modifiers(TRUE) has been called before the
@@ -58,12 +91,24 @@ RCSID("$Id: getch.c,v 1.72 2008/07/13 16:08:18 wmcbrine Exp $")
         to return modifier keys pressed alone as keystrokes (KEY_ALT_L,
         etc.). These may not work on all platforms.
 
+        Text pasted into a terminal that brackets pastes comes in as
+        one block. By default, wgetch() hands it over a character at a
+        time, like typing. After PDC_return_paste(TRUE), it returns
+        KEY_PASTE instead, even outside keypad mode; the text is then
+        read with get_paste(), which copies up to n - 1 bytes of it to
+        buf, and may be called until it returns 0. Whatever is left
+        unread at the next wgetch() is dropped. With echo() on, the
+        whole paste is echoed with a single refresh. wgetnstr() takes
+        pastes in bulk in this way by itself.
+
         NOTE: getch() and ungetch() are implemented as macros, to avoid
         conflict with many DOS compiler's runtime libraries.
 
   Return Value:
         These functions return ERR or the value of the character, meta
-        character or function key token.
+        character or function key token; wgetch_r() may also return
+        PDC_WOULDBLOCK. wgetch_batch() returns the number of keys
+        stored in keys, or ERR.
 
   Portability                                X/Open    BSD    SYS V
         getch                                   Y       Y       Y
@@ -72,15 +117,22 @@ RCSID("$Id: getch.c,v 1.72 2008/07/13 16:08:18 wmcbrine Exp $")
         mvwgetch                                Y       Y       Y
         ungetch                                 Y       Y       Y
         flushinp                                Y       Y       Y
+        wgetch_wake                             -       -       -
+        wgetch_r                                -       -       -
+        wgetch_batch                            -       -       -
         get_wch                                 Y
         wget_wch                                Y
         mvget_wch                               Y
         mvwget_wch                              Y
         unget_wch                               Y
         PDC_get_key_modifiers                   -       -       -
+        PDC_return_paste                        -       -       -
+        get_paste                               -       -       -
 
 **man-end****************************************************************/
 
+#include <string.h>
+
 static int _mouse_key(SESSION *S, WINDOW *win)
 {
     int i, key = KEY_MOUSE;
@@ -149,83 +201,246 @@ static int _mouse_key(SESSION *S, WINDOW *win)
     return key;
 }
 
-int wgetch(SESSION *S, WINDOW *win)
+/* Note the arrival of a key read: the platform's time for it, if it
+   gave one, or now */
+
+static void _arrived(SESSION *S)
 {
-    int key, waitcount;
+    if (!S->key_arrival)
+        S->key_arrival = PDC_stats_usec();
 
-    PDC_LOG(("wgetch() - called\n"));
+    if (!S->input_since || (long)(S->key_arrival - S->input_since) < 0)
+        S->input_since = S->key_arrival;
+}
 
-    if (!S || !win)
-        return ERR;
+static int _read_key(SESSION *S)
+{
+    int key;
 
-    waitcount = 0;
+    S->key_arrival = 0;
+    key = PDC_get_key(S);
+    _arrived(S);
+
+    return key;
+}
 
-     /* set the number of 1/20th second napms() calls */
+/* Queue a mouse event that passed the filters, with any more reports
+   already waiting, so that a burst of them can be merged; a key read
+   past them is held for the next wgetch() */
 
-    if (S->SP->delaytenths)
-        waitcount = 2 * S->SP->delaytenths;
-    else
-        if (win->_delayms)
+static void _mouse_queue(SESSION *S, WINDOW *win)
+{
+    int i, key;
+
+    PDC_mouse_push(S);
+
+    for (i = 0; i < PDC_MOUSE_AHEAD && PDC_check_key(S); i++)
+    {
+        key = _read_key(S);
+
+        if (S->SP->key_code && key == KEY_MOUSE)
         {
-            /* Can't really do millisecond intervals, so delay in
-               1/20ths of a second (50ms) */
+            key = _mouse_key(S, win);
+
+            if (key == KEY_MOUSE)
+            {
+                PDC_mouse_push(S);
+                continue;
+            }
 
-            waitcount = win->_delayms / 50;
-            if (!waitcount)
-                waitcount = 1;
+            if (key == -1)
+                continue;
         }
 
-    /* refresh window when wgetch is called if there have been changes
-       to it and it is not a pad */
+        S->key_held = TRUE;
+        S->key_held_key = key;
+        S->key_held_code = S->SP->key_code;
+        S->key_held_arrival = S->key_arrival;
+        break;
+    }
+}
 
-    if (!(win->_flags & _PAD) && ((!win->_leaveit &&
-         (win->_begx + win->_curx != S->SP->curscol ||
-          win->_begy + win->_cury != S->SP->cursrow)) || is_wintouched(S, win)))
-        wrefresh(S, win);
+/* Is a key ready without waiting? Used by typeahead() and echo. */
 
-    /* if ungotten char exists, remove and return it */
+bool PDC_input_pending(SESSION *S)
+{
+    return S->getch_c_ungind || S->key_held ||
+           S->mouseq_told < S->mouseq_len ||
+           (S->paste_pos < S->paste_len && !S->paste_delivered) ||
+           PDC_keyring_pending(S) || PDC_check_key(S);
+}
+
+/* Echo, and wgetnstr(), refresh only once the input drains, or
+   PDC_ECHO_DEFER_MS after the first key left unrefreshed, so that a
+   paste isn't drawn one key at a time. Returns TRUE if the refresh
+   should be put off. */
 
-    if (S->getch_c_ungind)
-        return S->getch_c_ungch[--S->getch_c_ungind];
+bool PDC_defer_refresh(SESSION *S)
+{
+    if (!PDC_input_pending(S))
+    {
+        S->echo_pending = FALSE;
+        return FALSE;
+    }
+
+    if (!S->echo_pending)
+    {
+        S->echo_pending = TRUE;
+        S->echo_since = PDC_get_clock(S);
+        return TRUE;
+    }
 
-    /* if normal and data in buffer */
+    if ((long)(PDC_get_clock(S) - S->echo_since) >= PDC_ECHO_DEFER_MS)
+    {
+        S->echo_pending = FALSE;
+        return FALSE;
+    }
 
-    if ((!S->SP->raw_inp && !S->SP->cbreak) && (S->getch_c_gindex < S->getch_c_pindex))
-        return S->getch_buffer[S->getch_c_gindex++];
+    return TRUE;
+}
 
-    /* prepare to buffer data */
+/* The loop behind wgetch() and wgetch_r(), run until a key is ready
+   to return. When block is FALSE and it would have to wait, it returns
+   PDC_WOULDBLOCK instead, setting *ms to the time left before the
+   timeout, or -1 if there is none. */
 
-    S->getch_c_pindex = 0;
-    S->getch_c_gindex = 0;
+static int _getkey(SESSION *S, WINDOW *win, bool block, int *ms)
+{
+    int key;
 
-    /* to get here, no keys are buffered. go and get one. */
+    /* what the application didn't get_paste() of its last KEY_PASTE
+       is dropped */
+
+    if (S->paste_delivered)
+    {
+        S->paste_delivered = FALSE;
+        S->paste_pos = S->paste_len = 0;
+    }
 
     for (;;)            /* loop for any buffering */
     {
-        /* is there a keystroke ready? */
+        /* each queued mouse event is returned as a KEY_MOUSE */
 
-        if (!PDC_check_key(S))
+        if (S->mouseq_told < S->mouseq_len)
         {
-            /* if not, handle timeout() and halfdelay() */
+            S->mouseq_told++;
+            S->SP->key_code = TRUE;
+            return KEY_MOUSE;
+        }
 
-            if (S->SP->delaytenths || win->_delayms)
+        /* is there a keystroke ready: a paste, a key held back by
+           _mouse_queue(), a key pushed by another thread, or one from
+           the platform? */
+
+        if (S->paste_pos < S->paste_len)
+        {
+            if (S->return_paste)
             {
-                if (!waitcount)
-                    return ERR;
+                key = KEY_PASTE;
+                S->SP->key_code = TRUE;
+            }
+            else                    /* replayed as ordinary keys */
+            {
+                key = (unsigned char)S->paste_buf[S->paste_pos++];
+                S->SP->key_code = FALSE;
+            }
+        }
+        else if (S->key_held)
+        {
+            S->key_held = FALSE;
+            key = S->key_held_key;
+            S->SP->key_code = S->key_held_code;
+            S->key_arrival = S->key_held_arrival;
+        }
+        else if (PDC_keyring_pop(S, &key))
+            _arrived(S);            /* it set SP->key_code, as below */
+        else if (PDC_check_key(S))
+            key = _read_key(S);     /* if there is, fetch it */
+        else
+        {
+            /* if not, run the timers that are due, and show what they
+               drew in one update; then check again */
+
+            int wait = S->getch_delay;
+            int rc = PDC_WAIT_INPUT;
+
+            if (PDC_timer_run(S))
+            {
+                if (!(win->_flags & _PAD))
+                    wnoutrefresh(S, win);
 
-                waitcount--;
+                doupdate(S);
+                continue;
+            }
+
+            /* an echo put off for the keys that seemed to follow it must
+               be shown now, if they were filtered out */
+
+            if (S->echo_pending)
+            {
+                S->echo_pending = FALSE;
+                wrefresh(S, win);
             }
-            else
-                if (win->_nodelay)
+
+            /* handle timeout(), halfdelay() and nodelay() */
+
+            if (wait > 0)
+            {
+                long left = (long)(S->getch_deadline - PDC_get_clock(S));
+
+                if (left <= 0)
                     return ERR;
 
-            napms(S, 50);  /* sleep for 1/20th second */
+                wait = (int)left;
+            }
+            else if (!wait)
+                return ERR;
+
+            /* sleep no longer than the next timer */
+
+            wait = PDC_timer_wait(S, wait);
+
+            if (!block)
+            {
+                if (ms)
+                    *ms = wait;
+
+                return PDC_WOULDBLOCK;
+            }
+
+            /* sleep until there's input, the time is up, or
+               wgetch_wake() is called; keyring_push() also wakes us */
+
+            if (PDC_keyring_sleep(S))
+                rc = PDC_clock_wait(S, wait);
+
+            PDC_keyring_awake(S);
+
+            if (rc == PDC_WAIT_WOKEN && PDC_keyring_woken(S))
+                return ERR;
+
             continue;   /* then check again */
         }
 
-        /* if there is, fetch it */
+        /* a paste, gathered by the platform with PDC_paste_add(), goes
+           out whole, echoed with one refresh */
+
+        if (S->SP->key_code && key == KEY_PASTE)
+        {
+            if (!S->return_paste || S->paste_pos == S->paste_len)
+                continue;
+
+            if (S->SP->echo)
+            {
+                waddnstr(S, win, S->paste_buf + S->paste_pos,
+                         S->paste_len - S->paste_pos);
+                wrefresh(S, win);
+            }
 
-        key = PDC_get_key(S);
+            S->paste_delivered = TRUE;
+
+            return key;
+        }
 
         if (S->SP->key_code)
         {
@@ -238,7 +453,15 @@ int wgetch(SESSION *S, WINDOW *win)
                area to function keys */
 
             else if (key == KEY_MOUSE)
+            {
                 key = _mouse_key(S, win);
+
+                if (key == KEY_MOUSE)
+                {
+                    _mouse_queue(S, win);
+                    continue;
+                }
+            }
         }
 
         /* unwanted key? loop back */
@@ -256,7 +479,11 @@ int wgetch(SESSION *S, WINDOW *win)
         if (S->SP->echo && !S->SP->key_code)
         {
             waddch(S, win, key);
-            wrefresh(S, win);
+
+            /* wgetch_batch() refreshes once, at the end */
+
+            if (!S->getch_batch && !PDC_defer_refresh(S))
+                wrefresh(S, win);
         }
 
         /* if no buffering */
@@ -282,6 +509,167 @@ int wgetch(SESSION *S, WINDOW *win)
     }
 }
 
+/* refresh window when wgetch is called if there have been changes to
+   it and it is not a pad */
+
+static void _refresh_check(SESSION *S, WINDOW *win)
+{
+    if (S->echo_pending && PDC_defer_refresh(S))
+        return;
+
+    if (!(win->_flags & _PAD) && ((!win->_leaveit &&
+         (win->_begx + win->_curx != S->SP->curscol ||
+          win->_begy + win->_cury != S->SP->cursrow)) ||
+         is_wintouched(S, win)))
+        wrefresh(S, win);
+}
+
+static int _getch(SESSION *S, WINDOW *win, bool block, int *ms)
+{
+    int key;
+
+    /* a call that returned PDC_WOULDBLOCK carries on where it was */
+
+    if (!S->getch_resume)
+    {
+        /* milliseconds to wait for a key: -1 blocks, 0 doesn't wait */
+
+        if (S->SP->delaytenths)
+            S->getch_delay = 100 * S->SP->delaytenths;
+        else if (win->_delayms)
+            S->getch_delay = win->_delayms;
+        else
+            S->getch_delay = win->_nodelay ? 0 : -1;
+
+        if (S->getch_delay > 0)
+            S->getch_deadline = PDC_get_clock(S) + S->getch_delay;
+
+        _refresh_check(S, win);
+
+        /* if ungotten char exists, remove and return it */
+
+        if (S->getch_c_ungind)
+            return S->getch_c_ungch[--S->getch_c_ungind];
+
+        /* if normal and data in buffer */
+
+        if ((!S->SP->raw_inp && !S->SP->cbreak) &&
+            (S->getch_c_gindex < S->getch_c_pindex))
+            return S->getch_buffer[S->getch_c_gindex++];
+
+        /* prepare to buffer data */
+
+        S->getch_c_pindex = 0;
+        S->getch_c_gindex = 0;
+
+        S->getch_resume = TRUE;
+    }
+
+    /* to get here, no keys are buffered. go and get one. */
+
+    key = _getkey(S, win, block, ms);
+
+    if (key != PDC_WOULDBLOCK)
+        S->getch_resume = FALSE;
+
+    return key;
+}
+
+int wgetch(SESSION *S, WINDOW *win)
+{
+    int key;
+
+    PDC_LOG(("wgetch() - called\n"));
+
+    if (!S || !win)
+        return ERR;
+
+    key = _getch(S, win, TRUE, NULL);
+
+    PDC_TRACE(S, PDC_TR_WGETCH, win, win->_cury, win->_curx, key);
+
+    return key;
+}
+
+int wgetch_r(SESSION *S, WINDOW *win, int *ms)
+{
+    int key;
+
+    PDC_LOG(("wgetch_r() - called\n"));
+
+    if (!S || !win)
+        return ERR;
+
+    key = _getch(S, win, FALSE, ms);
+
+    if (key != PDC_WOULDBLOCK)
+        PDC_TRACE(S, PDC_TR_WGETCH, win, win->_cury, win->_curx, key);
+
+    return key;
+}
+
+int wgetch_batch(SESSION *S, WINDOW *win, int *keys, int max, int timeout_ms)
+{
+    int n = 0;
+
+    PDC_LOG(("wgetch_batch() - called: max %d\n", max));
+
+    if (!S || !win || !keys || max < 1)
+        return ERR;
+
+    _refresh_check(S, win);
+
+    /* the first key may be waited for; later ones only if queued */
+
+    S->getch_delay = timeout_ms < 0 ? -1 : timeout_ms;
+
+    if (S->getch_delay > 0)
+        S->getch_deadline = PDC_get_clock(S) + S->getch_delay;
+
+    S->getch_batch = TRUE;
+
+    for (;;)
+    {
+        int key;
+
+        while (n < max && S->getch_c_ungind)
+            keys[n++] = S->getch_c_ungch[--S->getch_c_ungind];
+
+        if (!S->SP->raw_inp && !S->SP->cbreak)
+            while (n < max && S->getch_c_gindex < S->getch_c_pindex)
+                keys[n++] = S->getch_buffer[S->getch_c_gindex++];
+
+        if (n == max)
+            break;
+
+        if (n)
+            S->getch_delay = 0;
+
+        S->getch_c_pindex = 0;
+        S->getch_c_gindex = 0;
+
+        if ((key = _getkey(S, win, TRUE, NULL)) == ERR)
+            break;
+
+        keys[n++] = key;
+
+        /* the next _getkey() would drop the paste's text */
+
+        if (S->paste_delivered)
+            break;
+    }
+
+    S->getch_batch = FALSE;
+    S->getch_resume = FALSE;
+
+    if (n && S->SP->echo)
+        wrefresh(S, win);
+
+    PDC_TRACE(S, PDC_TR_WGETCH_BATCH, win, win->_cury, win->_curx, n);
+
+    return n;
+}
+
 int mvgetch(SESSION *S, int y, int x)
 {
     PDC_LOG(("mvgetch() - called\n"));
@@ -317,6 +705,16 @@ int PDC_ungetch(SESSION *S, int ch)
     return OK;
 }
 
+int wgetch_wake(SESSION *S)
+{
+    PDC_LOG(("wgetch_wake() - called\n"));
+
+    if (!S)
+        return ERR;
+
+    return PDC_keyring_wake(S);
+}
+
 int flushinp(SESSION *S)
 {
     PDC_LOG(("flushinp() - called\n"));
@@ -325,6 +723,11 @@ int flushinp(SESSION *S)
         return ERR;
 
     PDC_flushinp(S);
+    PDC_keyring_flush(S);
+    PDC_keydec_flush(S);
+
+    S->mouseq_len = S->mouseq_told = 0;
+    S->key_held = FALSE;
 
     S->getch_c_gindex = 1;           /* set indices to kill buffer */
     S->getch_c_pindex = 0;
@@ -350,6 +753,83 @@ int PDC_save_key_modifiers(SESSION *S, bool flag)
     return OK;
 }
 
+int PDC_return_paste(SESSION *S, bool flag)
+{
+    PDC_LOG(("PDC_return_paste() - called\n"));
+
+    if (!S)
+        return ERR;
+
+    S->return_paste = flag;
+
+    return OK;
+}
+
+int get_paste(SESSION *S, char *buf, int n)
+{
+    int len;
+
+    PDC_LOG(("get_paste() - called\n"));
+
+    if (!S || !buf || n < 1)
+        return ERR;
+
+    len = min(n - 1, S->paste_len - S->paste_pos);
+
+    memcpy(buf, S->paste_buf + S->paste_pos, len);
+    buf[len] = '\0';
+
+    S->paste_pos += len;
+
+    return len;
+}
+
+/* Called by the platform for the text of a bracketed paste; it then
+   returns KEY_PASTE from PDC_get_key(). */
+
+int PDC_paste_add(SESSION *S, const char *text, int len)
+{
+    if (!S || !text || len < 0)
+        return ERR;
+
+    if (S->paste_pos == S->paste_len)
+        S->paste_pos = S->paste_len = 0;
+
+    if (S->paste_len + len > S->paste_size)
+    {
+        int size = max(S->paste_size * 2, S->paste_len + len);
+        char *buf = PDC_smalloc(S, size);
+
+        if (!buf)
+            return ERR;
+
+        if (S->paste_buf)
+        {
+            memcpy(buf, S->paste_buf, S->paste_len);
+            PDC_sfree(S, S->paste_buf);
+        }
+
+        S->paste_buf = buf;
+        S->paste_size = size;
+    }
+
+    memcpy(S->paste_buf + S->paste_len, text, len);
+    S->paste_len += len;
+
+    return OK;
+}
+
+void PDC_paste_free(SESSION *S)
+{
+    if (!S || !S->paste_buf)
+        return;
+
+    PDC_sfree(S, S->paste_buf);
+
+    S->paste_buf = NULL;
+    S->paste_len = S->paste_pos = S->paste_size = 0;
+}
+
 int PDC_return_key_modifiers(SESSION *S, bool flag)
 {
     PDC_LOG(("PDC_return_key_modifiers() - called\n"));
@@ -17,6 +17,7 @@ RCSID("$Id: getstr.c,v 1.51 2008/07/14 04:24:51 wmcbrine Exp $")
         int wgetnstr(WINDOW *win, char *str, int n);
         int mvgetnstr(int y, int x, char *str, int n);
         int mvwgetnstr(WINDOW *win, int y, int x, char *str, int n);
+        int wgetnstr_r(WINDOW *win, char *str, int n, int *ms);
 
         int get_wstr(wint_t *wstr);
         int wget_wstr(WINDOW *win, wint_t *wstr);
@@ -35,14 +36,25 @@ RCSID("$Id: getstr.c,v 1.51 2008/07/14 04:24:51 wmcbrine Exp $")
         functions convert the wgetch()'d values into a multibyte string
         in the current locale before returning it. The resulting string
         is placed in the area pointed to by *str. The routines with n as
-        the last argument read at most n characters.
+        the last argument read at most n characters. As with the echo
+        of wgetch(), keys that arrive together are drawn together.
 
         Note that there's no way to know how long the buffer passed to
         wgetstr() is, so use wgetnstr() to avoid buffer overflows.
 
+        wgetnstr_r() is the resumable form of wgetnstr(), built on
+        wgetch_r(). It returns PDC_WOULDBLOCK when the line isn't
+        complete and no key is ready, setting *ms as wgetch_r() does;
+        the caller then waits and calls it again with the same str and
+        n, until it returns OK. Only one line at a time can be in
+        progress in a session.
+
   Return Value:
         This functions return ERR on failure or any other value on
-        success.
+        success. wgetnstr_r() may also return PDC_WOULDBLOCK. If
+        wgetch() returns ERR, from a timeout or wgetch_wake(), the line
+        ends there: str holds what was read before it, and ERR is
+        returned.
 
   Portability                                X/Open    BSD    SYS V
         getstr                                  Y       Y       Y
@@ -61,143 +73,273 @@ RCSID("$Id: getstr.c,v 1.51 2008/07/14 04:24:51 wmcbrine Exp $")
         wgetn_wstr                              Y
         mvgetn_wstr                             Y
         mvwgetn_wstr                            Y
+        wgetnstr_r                              -       -       -
 
 **man-end****************************************************************/
 
-#define MAXLINE 255
-
-int wgetnstr(SESSION *S, WINDOW *win, char *str, int n)
-{
-    int ch, i, num, x, chars;
-    char *p;
-    bool stop, oldecho, oldcbreak, oldnodelay;
-
-    PDC_LOG(("wgetnstr() - called\n"));
+#include <string.h>
 
-    if (!S || !win || !str)
-        return ERR;
+#define MAXLINE 255
 
-    chars = 0;
-    p = str;
-    stop = FALSE;
+/* wgetnstr() keeps its state in the session between keys, so that
+   wgetnstr_r() can return in the middle of a line and carry on later */
 
-    x = win->_curx;
+static void _getstr_begin(SESSION *S, WINDOW *win)
+{
+    S->getstr_chars = 0;
+    S->getstr_pos = 0;
+    S->getstr_x = win->_curx;
 
-    oldcbreak = S->SP->cbreak; /* remember states */
-    oldecho = S->SP->echo;
-    oldnodelay = win->_nodelay;
+    S->getstr_oldcbreak = S->SP->cbreak; /* remember states */
+    S->getstr_oldecho = S->SP->echo;
+    S->getstr_oldnodelay = win->_nodelay;
+    S->getstr_oldpaste = S->return_paste;
 
     S->SP->echo = FALSE;       /* we do echo ourselves */
     cbreak(S);               /* ensure each key is returned immediately */
     win->_nodelay = FALSE;  /* don't return -1 */
+    S->return_paste = TRUE; /* take pastes in one go */
+
+    S->getstr_active = TRUE;
 
     wrefresh(S, win);
+}
 
-    while (!stop)
-    {
-        ch = wgetch(S, win);
+/* handle one key; returns TRUE at the end of the line */
 
-        switch (ch)
-        {
+static bool _getstr_char(SESSION *S, WINDOW *win, char *str, int n, int ch)
+{
+    int i, num;
+    int x = S->getstr_x;
+    int chars = S->getstr_chars;
+    char *p = str + S->getstr_pos;
+    bool stop = FALSE, oldecho = S->getstr_oldecho;
 
-        case '\t':
-            ch = ' ';
-            num = S->TABSIZE - (win->_curx - x) % S->TABSIZE;
-            for (i = 0; i < num; i++)
-            {
-                if (chars < n)
-                {
-                    if (oldecho)
-                        waddch(S, win, ch);
-                    *p++ = ch;
-                    ++chars;
-                }
-                else
-                    beep(S);
-            }
-            break;
+    switch (ch)
+    {
 
-        case _ECHAR:        /* CTRL-H -- Delete character */
-            if (p > str)
+    case '\t':
+        ch = ' ';
+        num = S->TABSIZE - (win->_curx - x) % S->TABSIZE;
+        for (i = 0; i < num; i++)
+        {
+            if (chars < n)
             {
                 if (oldecho)
-                    waddstr(S, win, "\b \b");
-                ch = (unsigned char)(*--p);
-                if ((ch < ' ') && (oldecho))
-                    waddstr(S, win, "\b \b");
-                chars--;
+                    waddch(S, win, ch);
+                *p++ = ch;
+                ++chars;
             }
-            break;
+            else
+                beep(S);
+        }
+        break;
+
+    case _ECHAR:        /* CTRL-H -- Delete character */
+        if (p > str)
+        {
+            if (oldecho)
+                waddstr(S, win, "\b \b");
+            ch = (unsigned char)(*--p);
+            if ((ch < ' ') && (oldecho))
+                waddstr(S, win, "\b \b");
+            chars--;
+        }
+        break;
 
-        case _DLCHAR:       /* CTRL-U -- Delete line */
-            while (p > str)
+    case _DLCHAR:       /* CTRL-U -- Delete line */
+        while (p > str)
+        {
+            if (oldecho)
+                waddstr(S, win, "\b \b");
+            ch = (unsigned char)(*--p);
+            if ((ch < ' ') && (oldecho))
+                waddstr(S, win, "\b \b");
+        }
+        chars = 0;
+        break;
+
+    case _DWCHAR:       /* CTRL-W -- Delete word */
+
+        while ((p > str) && (*(p - 1) == ' '))
+        {
+            if (oldecho)
+                waddstr(S, win, "\b \b");
+
+            --p;        /* remove space */
+            chars--;
+        }
+        while ((p > str) && (*(p - 1) != ' '))
+        {
+            if (oldecho)
+                waddstr(S, win, "\b \b");
+
+            ch = (unsigned char)(*--p);
+            if ((ch < ' ') && (oldecho))
+                waddstr(S, win, "\b \b");
+            chars--;
+        }
+        break;
+
+    case '\n':
+    case '\r':
+        stop = TRUE;
+        if (oldecho)
+            waddch(S, win, '\n');
+        break;
+
+    default:
+        if (chars < n)
+        {
+            if (!S->SP->key_code && ch < 0x100)
             {
+                *p++ = ch;
                 if (oldecho)
-                    waddstr(S, win, "\b \b");
-                ch = (unsigned char)(*--p);
-                if ((ch < ' ') && (oldecho))
-                    waddstr(S, win, "\b \b");
+                    waddch(S, win, ch);
+                chars++;
             }
-            chars = 0;
-            break;
+        }
+        else
+            beep(S);
 
-        case _DWCHAR:       /* CTRL-W -- Delete word */
+        break;
 
-            while ((p > str) && (*(p - 1) == ' '))
-            {
-                if (oldecho)
-                    waddstr(S, win, "\b \b");
+    }
 
-                --p;        /* remove space */
-                chars--;
-            }
-            while ((p > str) && (*(p - 1) != ' '))
-            {
-                if (oldecho)
-                    waddstr(S, win, "\b \b");
+    S->getstr_chars = chars;
+    S->getstr_pos = (int)(p - str);
 
-                ch = (unsigned char)(*--p);
-                if ((ch < ' ') && (oldecho))
-                    waddstr(S, win, "\b \b");
-                chars--;
-            }
-            break;
+    return stop;
+}
 
-        case '\n':
-        case '\r':
-            stop = TRUE;
-            if (oldecho)
-                waddch(S, win, '\n');
-            break;
+/* Take a paste in bulk: runs of printable text are copied and echoed
+   whole; other characters go through _getstr_char(). What follows an
+   end of line is left for the next read. */
 
-        default:
-            if (chars < n)
-            {
-                if (!S->SP->key_code && ch < 0x100)
-                {
-                    *p++ = ch;
-                    if (oldecho)
-                        waddch(S, win, ch);
-                    chars++;
-                }
-            }
-            else
-                beep(S);
+static bool _getstr_paste(SESSION *S, WINDOW *win, char *str, int n)
+{
+    bool stop = FALSE;
 
-            break;
+    S->SP->key_code = FALSE;
+
+    while (!stop && S->paste_pos < S->paste_len)
+    {
+        const char *run = S->paste_buf + S->paste_pos;
+        int len = 0, take;
 
+        while (S->paste_pos + len < S->paste_len &&
+               (unsigned char)run[len] >= ' ' && run[len] != 0x7f)
+            len++;
+
+        if (!len)
+        {
+            int ch = (unsigned char)S->paste_buf[S->paste_pos++];
+
+            stop = _getstr_char(S, win, str, n, ch);
+
+            /* CR LF is one end of line */
+
+            if (stop && ch == '\r' && S->paste_pos < S->paste_len &&
+                S->paste_buf[S->paste_pos] == '\n')
+                S->paste_pos++;
+
+            continue;
         }
 
-        wrefresh(S, win);
+        take = min(len, n - S->getstr_chars);
+
+        if (take > 0)
+        {
+            memcpy(str + S->getstr_pos, run, take);
+
+            if (S->getstr_oldecho)
+                waddnstr(S, win, run, take);
+
+            S->getstr_pos += take;
+            S->getstr_chars += take;
+        }
+
+        if (take < len)
+            beep(S);
+
+        S->paste_pos += len;
     }
 
-    *p = '\0';
+    S->paste_delivered = FALSE;     /* keep any rest for later */
+
+    return stop;
+}
+
+static bool _getstr_key(SESSION *S, WINDOW *win, char *str, int n, int ch)
+{
+    bool stop;
+
+    if (ch == KEY_PASTE && S->SP->key_code)
+        stop = _getstr_paste(S, win, str, n);
+    else
+        stop = _getstr_char(S, win, str, n, ch);
+
+    if (stop || !PDC_defer_refresh(S))
+        wrefresh(S, win);
+
+    return stop;
+}
+
+static int _getnstr(SESSION *S, WINDOW *win, char *str, int n, bool block,
+                    int *ms)
+{
+    int ch, rc = OK;
+
+    if (!S->getstr_active)
+        _getstr_begin(S, win);
+
+    do
+    {
+        ch = block ? wgetch(S, win) : wgetch_r(S, win, ms);
+
+        if (ch == PDC_WOULDBLOCK)
+            return PDC_WOULDBLOCK;
+
+        /* a timeout, halfdelay() or wgetch_wake() ends the line, with
+           what was read so far */
+
+        if (ch == ERR)
+        {
+            rc = ERR;
+            break;
+        }
+    } while (!_getstr_key(S, win, str, n, ch));
+
+    str[S->getstr_pos] = '\0';
+
+    S->SP->echo = S->getstr_oldecho;     /* restore old settings */
+    S->SP->cbreak = S->getstr_oldcbreak;
+    win->_nodelay = S->getstr_oldnodelay;
+    S->return_paste = S->getstr_oldpaste;
+
+    S->getstr_active = FALSE;
 
-    S->SP->echo = oldecho;     /* restore old settings */
-    S->SP->cbreak = oldcbreak;
-    win->_nodelay = oldnodelay;
+    return rc;
+}
+
+int wgetnstr(SESSION *S, WINDOW *win, char *str, int n)
+{
+    PDC_LOG(("wgetnstr() - called\n"));
+
+    if (!S || !win || !str)
+        return ERR;
+
+    return _getnstr(S, win, str, n, TRUE, NULL);
+}
+
+int wgetnstr_r(SESSION *S, WINDOW *win, char *str, int n, int *ms)
+{
+    PDC_LOG(("wgetnstr_r() - called\n"));
+
+    if (!S || !win || !str)
+        return ERR;
 
-    return OK;
+    return _getnstr(S, win, str, n, FALSE, ms);
 }
 
 int getstr(SESSION *S, char *str)
@@ -106,6 +106,13 @@ WINDOW *initscr(SESSION *S, void *userargs)
         fprintf(stderr, "initscr(): Unable to create SP\n");
         return NULL;
     }
+
+    S->COLORS = 0;
+    S->COLOR_PAIRS = PDC_COLOR_PAIRS;
+    S->default_colors = FALSE;
+    S->first_col = 0;
+    S->escdelay = PDC_ESCDELAY;
+
     if (PDC_scr_open(S, userargs) == ERR)
     {
         fprintf(stderr, "initscr(): Unable to open SP\n");
@@ -148,6 +155,18 @@ WINDOW *initscr(SESSION *S, void *userargs)
         return NULL;
     }
 
+    if (PDC_keyring_init(S) == ERR)
+    {
+        fprintf(stderr, "initscr(): Unable to create the key queue.\n");
+        return NULL;
+    }
+
+    if (PDC_keydec_init(S) == ERR)
+    {
+        fprintf(stderr, "initscr(): Unable to create the key decoder.\n");
+        return NULL;
+    }
+
     PDC_slk_initialize(S);
     S->LINES -= S->SP->slklines;
 
@@ -250,6 +269,13 @@ void delscreen(SESSION *S)
         return;
 
     PDC_slk_free(S);     /* free the soft label keys, if needed */
+    PDC_panel_free(S);   /* free the panel lookup map */
+    PDC_rowpar_free(S);  /* stop the doupdate() threads */
+    PDC_keyring_free(S); /* free the key queue */
+    PDC_keydec_free(S);  /* free the key decoder */
+    PDC_timer_free(S);   /* free the timers */
+    PDC_paste_free(S);   /* free the paste buffer */
+    PDC_trace_free(S);   /* free the trace ring */
 
     delwin(S, S->stdscr);
     delwin(S, S->curscr);
@@ -273,6 +299,8 @@ int resize_term(SESSION *S, int nlines, int ncols)
     if (!S->stdscr || PDC_resize_screen(S, nlines, ncols) == ERR)
         return ERR;
 
+    PDC_flash_end(S);   /* curscr is about to be replaced */
+
     int columns=80, rows=24;
     PDC_get_termsize(S, &columns, &rows);
     S->SP->cols = S->COLS = columns;
@@ -79,9 +79,16 @@ RCSID("$Id: inopts.c,v 1.43 2008/07/13 16:08:18 wmcbrine Exp $")
         returned immediately. If the delay is positive, the read blocks
         for the delay period; if the period expires, ERR is returned.
 
-        intrflush(), notimeout(), noqiflush(), qiflush() and typeahead()
-        do nothing in PDCurses, but are included for compatibility with
-        other curses implementations.
+        typeahead() controls whether doupdate() checks for input while
+        it updates the screen, and stops early if there is some, so
+        that a burst of keys isn't held up by frames the user has
+        already moved past. Any fildes other than -1 turns the check
+        on, for the session's own input; -1 turns it off. It is off by
+        default.
+
+        intrflush(), notimeout(), noqiflush() and qiflush() do nothing
+        in PDCurses, but are included for compatibility with other
+        curses implementations.
 
         crmode() and nocrmode() are archaic equivalents to cbreak() and
         nocbreak(), respectively.
@@ -251,7 +258,13 @@ void qiflush(SESSION *S)
 
 int typeahead(SESSION *S, int fildes)
 {
-    PDC_LOG(("typeahead() - called\n"));
+    PDC_LOG(("typeahead() - called: fildes %d\n", fildes));
+
+    if (!S)
+        return ERR;
+
+    S->typeahead = (fildes != -1);
+
     return OK;
 }
 
@@ -69,7 +69,7 @@ int winsch(SESSION *S, WINDOW *win, chtype ch)
     PDC_LOG(("winsch() - called: win=%p ch=%x (text=%c attr=0x%x)\n",
              win, ch, ch & A_CHARTEXT, ch & A_ATTRIBUTES));
 
-    if (!S || !win)
+    if (!S || !win || (win->_flags & _VPAD))
         return ERR;
 
     x = win->_curx;
@@ -151,6 +151,7 @@ int winsch(SESSION *S, WINDOW *win, chtype ch)
         temp = &win->_y[y][x];
 
         memmove(temp + 1, temp, (maxx - x - 1) * sizeof(chtype));
+        S->stats.cells_written += maxx - x;
 
         win->_lastch[y] = maxx - 1;
 
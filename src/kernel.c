@@ -56,7 +56,8 @@ RCSID("$Id: kernel.c,v 1.78 2008/07/15 17:13:26 wmcbrine Exp $")
         NULL init function pointer is an error.
 
         napms() suspends the program for the specified number of
-        milliseconds. draino() is an archaic equivalent.
+        milliseconds, by the session's clock (see PDC_set_clock()).
+        draino() is an archaic equivalent.
 
         resetterm(), fixterm() and saveterm() are archaic equivalents
         for reset_shell_mode(), reset_prog_mode() and def_prog_mode(),
@@ -86,22 +87,16 @@ RCSID("$Id: kernel.c,v 1.78 2008/07/15 17:13:26 wmcbrine Exp $")
 #include <string.h>
 
 
-static struct cttyset
-{
-    bool been_set;
-    SCREEN saved;
-} ctty[3];
-
 enum { PDC_SH_TTY, PDC_PR_TTY, PDC_SAVE_TTY };
 
 static void _save_mode(SESSION *S, int i)
 {
-    ctty[i].been_set = TRUE;
-
     if (!S)
         return;
 
-    memcpy(&(ctty[i].saved), S->SP, sizeof(SCREEN));
+    S->ctty[i].been_set = TRUE;
+
+    memcpy(&(S->ctty[i].saved), S->SP, sizeof(SCREEN));
 
     PDC_save_screen_mode(S, i);
 }
@@ -111,25 +106,25 @@ static int _restore_mode(SESSION *S, int i)
     if (!S)
         return ERR;
 
-    if (ctty[i].been_set == TRUE)
+    if (S->ctty[i].been_set == TRUE)
     {
-        memcpy(S->SP, &(ctty[i].saved), sizeof(SCREEN));
+        memcpy(S->SP, &(S->ctty[i].saved), sizeof(SCREEN));
 
-        if (ctty[i].saved.raw_out)
+        if (S->ctty[i].saved.raw_out)
             raw(S);
 
         PDC_restore_screen_mode(S, i);
 
-        if ((S->LINES != ctty[i].saved.lines) ||
-            (S->COLS != ctty[i].saved.cols))
-            resize_term(S, ctty[i].saved.lines, ctty[i].saved.cols);
+        if ((S->LINES != S->ctty[i].saved.lines) ||
+            (S->COLS != S->ctty[i].saved.cols))
+            resize_term(S, S->ctty[i].saved.lines, S->ctty[i].saved.cols);
 
-        PDC_curs_set(S, ctty[i].saved.visibility);
+        PDC_curs_set(S, S->ctty[i].saved.visibility);
 
-        PDC_gotoyx(S, ctty[i].saved.cursrow, ctty[i].saved.curscol);
+        PDC_gotoyx(S, S->ctty[i].saved.cursrow, S->ctty[i].saved.curscol);
     }
 
-    return ctty[i].been_set ? OK : ERR;
+    return S->ctty[i].been_set ? OK : ERR;
 }
 
 int def_prog_mode(SESSION *S)
@@ -213,8 +208,10 @@ int napms(SESSION *S, int ms)
 {
     PDC_LOG(("napms() - called: ms=%d\n", ms));
 
+    PDC_TRACE(S, PDC_TR_NAPMS, NULL, 0, 0, ms);
+
     if (ms)
-        PDC_napms(S, ms);
+        PDC_clock_sleep(S, ms);
 
     return OK;
 }
@@ -0,0 +1,964 @@
+/* Public Domain Curses */
+
+#include "curspriv.h"
+
+RCSID("$Id: keydec.c,v 1.1 $")
+
+/*man-start**************************************************************
+
+  Name:                                                         keydec
+
+  Synopsis:
+        int set_escdelay(SESSION *S, int ms);
+        int get_escdelay(SESSION *S);
+        unsigned long PDC_get_key_time(SESSION *S);
+
+  Description:
+        Platforms that read a byte stream, such as a terminal or a
+        network connection, share one decoder for the escape sequences
+        sent for function keys, modified keys, mouse reports and
+        bracketed pastes. It knows the xterm, rxvt and Linux console
+        forms, and reports the modifiers of each key through
+        PDC_get_key_modifiers(), when PDC_save_key_modifiers(TRUE) is
+        in effect. A sequence it doesn't know is dropped whole, rather
+        than being returned as keys.
+
+        An ESC is taken for the Escape key (or, followed by another
+        key, for Alt and that key) only when nothing completing a
+        sequence arrives within the escape delay. set_escdelay() sets
+        the delay of S, in milliseconds; it is PDC_ESCDELAY (100) after
+        initscr(). A longer delay suits slow links, where the bytes of
+        one sequence may arrive far apart. get_escdelay() returns it.
+
+        PDC_get_key_time() returns the time, by PDC_get_clock(), at
+        which the bytes of the last key read from the decoder arrived;
+        or 0 if none has been.
+
+  Return Value:
+        set_escdelay() returns ERR if ms is negative, and OK otherwise.
+        get_escdelay() returns the delay, or ERR if S is NULL.
+
+  Portability                                X/Open    BSD    SYS V
+        set_escdelay                            -       -       -
+        get_escdelay                            -       -       -
+        PDC_get_key_time                        -       -       -
+
+**man-end****************************************************************/
+
+#include <string.h>
+
+#define PDC_KEYDEC_QUEUE  64    /* decoded keys held; a power of two */
+#define PDC_KEYDEC_ROOM    2    /* most keys one byte can complete */
+#define PDC_KEYDEC_PARAMS  4    /* CSI parameters kept */
+#define PDC_KEYDEC_PARMAX  9999 /* larger parameters are clamped */
+#define PDC_KEYDEC_SEQMAX  64   /* longer sequences are skipped */
+
+/* Decoder states. The stream is decoded one byte at a time, except in
+   a paste, where the text is copied in runs. */
+
+enum
+{
+    ST_GROUND,      /* between keys */
+    ST_ESC,         /* after ESC */
+    ST_CSI,         /* after ESC [ */
+    ST_SS3,         /* after ESC O */
+    ST_X10,         /* after ESC [ M: three bytes of mouse report */
+    ST_SKIP,        /* in an overlong sequence, until its final byte */
+    ST_UTF8,        /* in a multibyte character */
+    ST_PASTE        /* between ESC [ 200 ~ and ESC [ 201 ~ */
+};
+
+struct _keyev
+{
+    int key;
+    bool special;               /* key is a KEY_* code */
+    unsigned long modifiers;    /* PDC_KEY_MODIFIER_* */
+    unsigned long time;         /* when its last byte arrived */
+    unsigned long arrival;      /* the same, by PDC_stats_usec() */
+    int paste;                  /* for KEY_PASTE, the bytes of its text */
+    MOUSE_STATUS mouse;         /* for KEY_MOUSE */
+};
+
+struct _keydec
+{
+    int state;
+    bool alt;                   /* ESC ESC: the key after is Alt'ed */
+    unsigned long since;        /* arrival of the sequence's last byte */
+    unsigned long arrival;      /* PDC_stats_usec() of the last feed */
+    int len;                    /* bytes after ESC [ or ESC O */
+    char marker;                /* CSI private marker, or 0 */
+    char inter;                 /* CSI intermediate byte, or 0 */
+    int nparam;
+    int param[PDC_KEYDEC_PARAMS];
+    int pmatch;                 /* bytes of the paste terminator seen */
+    int utf8_left;
+    int utf8_char;
+    int held;                   /* mouse buttons down, as bits */
+    MOUSE_STATUS mouse;
+    char *pbuf;                 /* text of the pastes not yet read, */
+    int plen;                   /* then of the one coming in */
+    int pdone;                  /* bytes of the finished ones */
+    int psize;
+    unsigned head, tail;
+    struct _keyev q[PDC_KEYDEC_QUEUE];
+};
+
+/* The key tables. CSI and SS3 sequences are looked up by final byte,
+   from '@'; sequences ending in ~ by their first parameter. Modifiers
+   come from the second parameter, as xterm sends them. */
+
+static const short csi_keys[0x3f] =
+{
+    ['A' - '@'] = KEY_UP,    ['B' - '@'] = KEY_DOWN,
+    ['C' - '@'] = KEY_RIGHT, ['D' - '@'] = KEY_LEFT,
+    ['E' - '@'] = KEY_B2,    ['F' - '@'] = KEY_END,
+    ['H' - '@'] = KEY_HOME,  ['P' - '@'] = KEY_F(1),
+    ['Q' - '@'] = KEY_F(2),  ['R' - '@'] = KEY_F(3),
+    ['S' - '@'] = KEY_F(4),  ['Z' - '@'] = KEY_BTAB
+};
+
+static const short ss3_keys[0x3f] =
+{
+    ['A' - '@'] = KEY_UP,    ['B' - '@'] = KEY_DOWN,
+    ['C' - '@'] = KEY_RIGHT, ['D' - '@'] = KEY_LEFT,
+    ['E' - '@'] = KEY_B2,    ['F' - '@'] = KEY_END,
+    ['H' - '@'] = KEY_HOME,  ['M' - '@'] = PADENTER,
+    ['P' - '@'] = KEY_F(1),  ['Q' - '@'] = KEY_F(2),
+    ['R' - '@'] = KEY_F(3),  ['S' - '@'] = KEY_F(4),
+    ['j' - '@'] = PADSTAR,   ['k' - '@'] = PADPLUS,
+    ['m' - '@'] = PADMINUS,  ['n' - '@'] = PADSTOP,
+    ['o' - '@'] = PADSLASH
+};
+
+static const short tilde_keys[35] =
+{
+    [1] = KEY_HOME,  [2] = KEY_IC,     [3] = KEY_DC,     [4] = KEY_END,
+    [5] = KEY_PPAGE, [6] = KEY_NPAGE,  [7] = KEY_HOME,   [8] = KEY_END,
+    [11] = KEY_F(1), [12] = KEY_F(2),  [13] = KEY_F(3),  [14] = KEY_F(4),
+    [15] = KEY_F(5), [17] = KEY_F(6),  [18] = KEY_F(7),  [19] = KEY_F(8),
+    [20] = KEY_F(9), [21] = KEY_F(10), [23] = KEY_F(11), [24] = KEY_F(12),
+    [25] = KEY_F(13), [26] = KEY_F(14), [28] = KEY_F(15), [29] = KEY_F(16),
+    [31] = KEY_F(17), [32] = KEY_F(18), [33] = KEY_F(19), [34] = KEY_F(20)
+};
+
+/* the PDCurses keys for modified cursor keys */
+
+static const short mod_keys[][4] =
+{
+    /* plain       shift          control     alt */
+    {KEY_UP,       KEY_SUP,       CTL_UP,     ALT_UP},
+    {KEY_DOWN,     KEY_SDOWN,     CTL_DOWN,   ALT_DOWN},
+    {KEY_LEFT,     KEY_SLEFT,     CTL_LEFT,   ALT_LEFT},
+    {KEY_RIGHT,    KEY_SRIGHT,    CTL_RIGHT,  ALT_RIGHT},
+    {KEY_HOME,     KEY_SHOME,     CTL_HOME,   ALT_HOME},
+    {KEY_END,      KEY_SEND,      CTL_END,    ALT_END},
+    {KEY_PPAGE,    KEY_SPREVIOUS, CTL_PGUP,   ALT_PGUP},
+    {KEY_NPAGE,    KEY_SNEXT,     CTL_PGDN,   ALT_PGDN},
+    {KEY_IC,       KEY_SIC,       CTL_INS,    ALT_INS},
+    {KEY_DC,       KEY_SDC,       CTL_DEL,    ALT_DEL}
+};
+
+static const char paste_end[] = "\033[201~";
+
+#define PASTE_END_LEN ((int)sizeof(paste_end) - 1)
+
+static bool _room(struct _keydec *d)
+{
+    return d->tail - d->head <= PDC_KEYDEC_QUEUE - PDC_KEYDEC_ROOM;
+}
+
+static void _emit(struct _keydec *d, int key, bool special,
+                  unsigned long mods, unsigned long now)
+{
+    struct _keyev *ev = d->q + (d->tail++ & (PDC_KEYDEC_QUEUE - 1));
+
+    ev->key = key;
+    ev->special = special;
+    ev->modifiers = mods;
+    ev->time = now;
+    ev->arrival = d->arrival;
+    ev->paste = 0;
+
+    if (special && key == KEY_MOUSE)
+        ev->mouse = d->mouse;
+}
+
+/* xterm's modifier parameter: 1 plus shift 1, alt 2, control 4,
+   meta 8 */
+
+static unsigned long _xmods(int m)
+{
+    unsigned long mods = 0;
+
+    if (m < 2)
+        return 0;
+
+    m--;
+
+    if (m & 1)
+        mods |= PDC_KEY_MODIFIER_SHIFT;
+    if (m & (2|8))
+        mods |= PDC_KEY_MODIFIER_ALT;
+    if (m & 4)
+        mods |= PDC_KEY_MODIFIER_CONTROL;
+
+    return mods;
+}
+
+static int _modkey(int key, unsigned long mods)
+{
+    int i, col;
+
+    if (!mods)
+        return key;
+
+    col = (mods & PDC_KEY_MODIFIER_ALT) ? 3 :
+          (mods & PDC_KEY_MODIFIER_CONTROL) ? 2 : 1;
+
+    /* as on the other platforms, shifted F1 is F13, and so on */
+
+    if (key >= KEY_F(1) && key <= KEY_F(12))
+        return key + 12 * col;
+
+    for (i = 0; i < (int)(sizeof(mod_keys) / sizeof(mod_keys[0])); i++)
+        if (mod_keys[i][0] == key)
+            return mod_keys[i][col];
+
+    return key;
+}
+
+static int _altkey(int c)
+{
+    if (c >= 'a' && c <= 'z')
+        return ALT_A + (c - 'a');
+
+    if (c >= 'A' && c <= 'Z')
+        return ALT_A + (c - 'A');
+
+    if (c >= '0' && c <= '9')
+        return ALT_0 + (c - '0');
+
+    switch (c)
+    {
+    case '-':
+        return ALT_MINUS;
+    case '=':
+        return ALT_EQUAL;
+    case '`':
+        return ALT_BQUOTE;
+    case '[':
+        return ALT_LBRACKET;
+    case ']':
+        return ALT_RBRACKET;
+    case ';':
+        return ALT_SEMICOLON;
+    case '\'':
+        return ALT_FQUOTE;
+    case ',':
+        return ALT_COMMA;
+    case '.':
+        return ALT_STOP;
+    case '/':
+        return ALT_FSLASH;
+    case '\\':
+        return ALT_BSLASH;
+    case '\t':
+        return ALT_TAB;
+    case '\r':
+    case '\n':
+        return ALT_ENTER;
+    case 0x08:
+    case 0x7f:
+        return ALT_BKSP;
+    case 0x1b:
+        return ALT_ESC;
+    }
+
+    return -1;
+}
+
+static void _alt(struct _keydec *d, int c, unsigned long now)
+{
+    int key = _altkey(c);
+
+    if (key == -1)
+        _emit(d, c, FALSE, PDC_KEY_MODIFIER_ALT, now);
+    else
+        _emit(d, key, TRUE, PDC_KEY_MODIFIER_ALT, now);
+}
+
+/* b is the xterm button code; x and y are 0 based */
+
+static void _mouse(struct _keydec *d, int b, int x, int y, bool release,
+                   unsigned long now)
+{
+    MOUSE_STATUS *m = &d->mouse;
+    unsigned long mods = 0;
+    short bmod = 0;
+    int i = b & 3, j;
+
+    if (b & 4)
+    {
+        mods |= PDC_KEY_MODIFIER_SHIFT;
+        bmod |= PDC_BUTTON_SHIFT;
+    }
+
+    if (b & 8)
+    {
+        mods |= PDC_KEY_MODIFIER_ALT;
+        bmod |= PDC_BUTTON_ALT;
+    }
+
+    if (b & 16)
+    {
+        mods |= PDC_KEY_MODIFIER_CONTROL;
+        bmod |= PDC_BUTTON_CONTROL;
+    }
+
+    m->x = x;
+    m->y = y;
+    m->changes = 0;
+
+    if (b & 64)
+    {
+        /* the wheel; 2 and 3 are sideways, which curses can't report */
+
+        if (i == 0)
+            m->changes = PDC_MOUSE_WHEEL_UP;
+        else if (i == 1)
+            m->changes = PDC_MOUSE_WHEEL_DOWN;
+    }
+    else if (b & 32)
+    {
+        if (i != 3 && (d->held & (1 << i)))
+        {
+            m->button[i] = BUTTON_MOVED | bmod;
+            m->changes = PDC_MOUSE_MOVED | (1 << i);
+        }
+        else
+            m->changes = PDC_MOUSE_POSITION;
+    }
+    else if (release || i == 3)
+    {
+        /* an X10 release doesn't say which button; it's all of them */
+
+        for (j = 0; j < 3; j++)
+            if ((i == 3) ? (d->held & (1 << j)) : (j == i))
+            {
+                m->button[j] = BUTTON_RELEASED | bmod;
+                m->changes |= 1 << j;
+                d->held &= ~(1 << j);
+            }
+    }
+    else
+    {
+        m->button[i] = BUTTON_PRESSED | bmod;
+        m->changes = 1 << i;
+        d->held |= 1 << i;
+    }
+
+    if (m->changes)
+        _emit(d, KEY_MOUSE, TRUE, mods, now);
+}
+
+static void _csi(struct _keydec *d, int final, unsigned long now)
+{
+    int p0 = d->nparam ? d->param[0] : 0;
+    int p1 = (d->nparam > 1) ? d->param[1] : 0;
+    unsigned long mods;
+    int key = 0;
+
+    if (d->marker == '<')
+    {
+        /* SGR mouse: ESC [ < b ; x ; y M, or m for a release */
+
+        if ((final == 'M' || final == 'm') && d->nparam >= 3)
+            _mouse(d, p0, p1 - 1, d->param[2] - 1, final == 'm', now);
+
+        return;
+    }
+
+    if (d->marker == '[')
+    {
+        /* the Linux console's F1 to F5 */
+
+        if (final >= 'A' && final <= 'E')
+            _emit(d, KEY_F(final - 'A' + 1), TRUE, 0, now);
+
+        return;
+    }
+
+    if (d->marker || d->inter)
+        return;
+
+    switch (final)
+    {
+    case 'M':
+        /* urxvt mouse: ESC [ b ; x ; y M */
+
+        if (d->nparam >= 3)
+            _mouse(d, p0 - 32, p1 - 1, d->param[2] - 1, FALSE, now);
+        return;
+
+    case '~':
+    case '$':
+    case '^':
+    case '@':
+        if (p0 == 200)
+        {
+            d->state = ST_PASTE;
+            d->pmatch = 0;
+            return;
+        }
+
+        if (p0 < (int)(sizeof(tilde_keys) / sizeof(tilde_keys[0])))
+            key = tilde_keys[p0];
+
+        /* rxvt shows the modifiers in the final byte */
+
+        mods = (final == '$') ? PDC_KEY_MODIFIER_SHIFT :
+               (final == '^') ? PDC_KEY_MODIFIER_CONTROL :
+               (final == '@') ? (PDC_KEY_MODIFIER_SHIFT |
+                                 PDC_KEY_MODIFIER_CONTROL) : _xmods(p1);
+        break;
+
+    case 'a':
+    case 'b':
+    case 'c':
+    case 'd':
+        /* rxvt's shifted arrows */
+
+        key = csi_keys[final - 'a' + 'A' - '@'];
+        mods = PDC_KEY_MODIFIER_SHIFT;
+        break;
+
+    default:
+        if (final < '@' || final > '~')
+            return;
+
+        key = csi_keys[final - '@'];
+        mods = _xmods(p1);
+    }
+
+    if (d->alt)
+        mods |= PDC_KEY_MODIFIER_ALT;
+
+    if (key)
+        _emit(d, _modkey(key, mods), TRUE, mods, now);
+}
+
+static void _ss3(struct _keydec *d, int final, unsigned long now)
+{
+    unsigned long mods;
+    int key;
+
+    /* the last parameter, if any, is the modifier */
+
+    mods = _xmods(d->nparam ? d->param[min(d->nparam,
+                                           PDC_KEYDEC_PARAMS) - 1] : 0);
+
+    if (d->alt)
+        mods |= PDC_KEY_MODIFIER_ALT;
+
+    if (final >= 'p' && final <= 'y')
+    {
+        /* the keypad digits, in application mode */
+
+        _emit(d, '0' + (final - 'p'), FALSE, mods, now);
+        return;
+    }
+
+    if (final >= 'a' && final <= 'd')
+    {
+        /* rxvt's control-arrows */
+
+        key = csi_keys[final - 'a' + 'A' - '@'];
+        mods |= PDC_KEY_MODIFIER_CONTROL;
+    }
+    else
+        key = ss3_keys[final - '@'];
+
+    if (key)
+        _emit(d, _modkey(key, mods), TRUE, mods, now);
+}
+
+static void _seq_start(struct _keydec *d, int state, unsigned long now)
+{
+    d->state = state;
+    d->alt = FALSE;
+    d->since = now;
+    d->len = 0;
+    d->marker = 0;
+    d->inter = 0;
+    d->nparam = 0;
+    d->param[0] = 0;
+}
+
+static void _param(struct _keydec *d, int c)
+{
+    int i;
+
+    if (c == ';' || c == ':')
+    {
+        if (!d->nparam)
+            d->nparam = 1;
+
+        if (d->nparam < PDC_KEYDEC_PARAMS)
+            d->param[d->nparam] = 0;
+
+        d->nparam++;
+        return;
+    }
+
+    if (!d->nparam)
+        d->nparam = 1;
+
+    i = d->nparam - 1;
+
+    if (i < PDC_KEYDEC_PARAMS)
+        d->param[i] = min(d->param[i] * 10 + (c - '0'), PDC_KEYDEC_PARMAX);
+}
+
+static void _byte(struct _keydec *d, int c, unsigned long now);
+
+/* a byte that can't be part of the sequence ends it, and is then
+   taken on its own */
+
+static void _abort(struct _keydec *d, int c, unsigned long now)
+{
+    d->state = ST_GROUND;
+    _byte(d, c, now);
+}
+
+static void _byte(struct _keydec *d, int c, unsigned long now)
+{
+    switch (d->state)
+    {
+    case ST_GROUND:
+        if (c == 0x1b)
+        {
+            _seq_start(d, ST_ESC, now);
+            return;
+        }
+#ifdef PDC_WIDE
+        if (c >= 0xc0 && c < 0xf8)
+        {
+            d->utf8_left = (c >= 0xf0) ? 3 : (c >= 0xe0) ? 2 : 1;
+            d->utf8_char = c & (0x3f >> d->utf8_left);
+            d->state = ST_UTF8;
+            d->since = now;
+            return;
+        }
+#endif
+        _emit(d, c, FALSE, 0, now);
+        return;
+
+    case ST_ESC:
+        d->since = now;
+
+        if (c == '[')
+            d->state = ST_CSI;
+        else if (c == 'O')
+            d->state = ST_SS3;
+        else if (c == 0x1b && !d->alt)
+            d->alt = TRUE;
+        else
+        {
+            d->state = ST_GROUND;
+
+            if (d->alt)
+            {
+                _emit(d, ALT_ESC, TRUE, PDC_KEY_MODIFIER_ALT, now);
+                _byte(d, c, now);
+            }
+            else if (c >= 0x80)
+            {
+                _emit(d, 0x1b, FALSE, 0, now);
+                _byte(d, c, now);
+            }
+            else
+                _alt(d, c, now);
+        }
+        return;
+
+    case ST_CSI:
+        d->since = now;
+
+        if (++d->len > PDC_KEYDEC_SEQMAX)
+        {
+            d->state = ST_SKIP;
+            _byte(d, c, now);
+        }
+        else if (c >= '0' && c <= '9')
+            _param(d, c);
+        else if (c == ';' || c == ':')
+            _param(d, c);
+        else if (d->len == 1 && ((c >= '<' && c <= '?') || c == '['))
+            d->marker = c;
+        else if (c == '$' && d->nparam)
+        {
+            d->state = ST_GROUND;
+            _csi(d, c, now);
+        }
+        else if (c >= 0x20 && c <= 0x2f)
+            d->inter = c;
+        else if (c == 'M' && d->len == 1)
+        {
+            d->state = ST_X10;
+            d->nparam = 0;
+        }
+        else if (c >= '@' && c <= '~')
+        {
+            d->state = ST_GROUND;
+            _csi(d, c, now);
+        }
+        else if (c == 0x1b)
+            _seq_start(d, ST_ESC, now);
+        else
+            _abort(d, c, now);
+        return;
+
+    case ST_SS3:
+        d->since = now;
+        d->len++;
+
+        if ((c >= '0' && c <= '9') || c == ';')
+            _param(d, c);
+        else if (c >= '@' && c <= '~')
+        {
+            d->state = ST_GROUND;
+            _ss3(d, c, now);
+        }
+        else if (c == 0x1b)
+            _seq_start(d, ST_ESC, now);
+        else
+            _abort(d, c, now);
+        return;
+
+    case ST_X10:
+        d->since = now;
+        d->param[d->nparam++] = c;
+
+        if (d->nparam == 3)
+        {
+            d->state = ST_GROUND;
+            _mouse(d, d->param[0] - 32, d->param[1] - 33,
+                   d->param[2] - 33, FALSE, now);
+        }
+        return;
+
+    case ST_SKIP:
+        d->since = now;
+
+        if (c >= '@' && c <= '~')
+            d->state = ST_GROUND;
+        else if (c == 0x1b)
+            _seq_start(d, ST_ESC, now);
+        return;
+
+    case ST_UTF8:
+        if ((c & 0xc0) != 0x80)
+        {
+            _abort(d, c, now);  /* the partial character is dropped */
+            return;
+        }
+
+        d->since = now;
+        d->utf8_char = (d->utf8_char << 6) | (c & 0x3f);
+
+        if (!--d->utf8_left)
+        {
+            d->state = ST_GROUND;
+            _emit(d, d->utf8_char, FALSE, 0, now);
+        }
+    }
+}
+
+/* Keep pasted text until the whole paste is in; it's given to
+   PDC_paste_add() when its KEY_PASTE is read, so that it comes after
+   the keys before it. If there's no room, the text is dropped. */
+
+static void _paste_text(SESSION *S, struct _keydec *d, const char *text,
+                        int len)
+{
+    if (d->plen + len > d->psize)
+    {
+        int size = max(max(d->psize * 2, d->plen + len), 256);
+        char *buf = PDC_smalloc(S, size);
+
+        if (!buf)
+            return;
+
+        if (d->pbuf)
+        {
+            memcpy(buf, d->pbuf, d->plen);
+            PDC_sfree(S, d->pbuf);
+        }
+
+        d->pbuf = buf;
+        d->psize = size;
+    }
+
+    memcpy(d->pbuf + d->plen, text, len);
+    d->plen += len;
+}
+
+/* Copy pasted text up to the terminator, in runs. Returns the number
+   of bytes taken. The terminator may be split across reads. */
+
+static int _paste(SESSION *S, struct _keydec *d, const unsigned char *p,
+                  int len, unsigned long now)
+{
+    int i = 0, start = 0;
+
+    while (i < len)
+    {
+        if (!d->pmatch)
+        {
+            const unsigned char *esc = memchr(p + i, 0x1b, len - i);
+
+            if (!esc)
+            {
+                i = len;
+                break;
+            }
+
+            i = (int)(esc - p);
+            _paste_text(S, d, (const char *)p + start, i - start);
+        }
+
+        if (p[i] == (unsigned char)paste_end[d->pmatch])
+        {
+            start = ++i;
+
+            if (++d->pmatch == PASTE_END_LEN)
+            {
+                d->state = ST_GROUND;
+                _emit(d, KEY_PASTE, TRUE, 0, now);
+
+                d->q[(d->tail - 1) & (PDC_KEYDEC_QUEUE - 1)].paste =
+                    d->plen - d->pdone;
+                d->pdone = d->plen;
+
+                return i;
+            }
+        }
+        else
+        {
+            /* not the end after all: what matched was text */
+
+            _paste_text(S, d, paste_end, d->pmatch);
+            d->pmatch = 0;
+            start = i;
+        }
+    }
+
+    if (!d->pmatch)
+        _paste_text(S, d, (const char *)p + start, i - start);
+
+    return i;
+}
+
+/* Resolve a sequence cut short by the escape delay */
+
+static void _expire(struct _keydec *d, unsigned long now)
+{
+    switch (d->state)
+    {
+    case ST_ESC:
+        if (d->alt)
+            _emit(d, ALT_ESC, TRUE, PDC_KEY_MODIFIER_ALT, now);
+        else
+            _emit(d, 0x1b, FALSE, 0, now);
+        break;
+
+    case ST_CSI:
+    case ST_SS3:
+        /* Alt-[ or Alt-O, if nothing followed; otherwise dropped */
+
+        if (!d->len)
+            _alt(d, (d->state == ST_CSI) ? '[' : 'O', now);
+    }
+
+    d->state = ST_GROUND;
+}
+
+int PDC_keydec_init(SESSION *S)
+{
+    if (!S)
+        return ERR;
+
+    if (S->keydec)
+        return OK;
+
+    if (!(S->keydec = PDC_scalloc(S, 1, sizeof(struct _keydec))))
+        return ERR;
+
+    S->keydec->mouse.x = S->keydec->mouse.y = -1;
+
+    return OK;
+}
+
+void PDC_keydec_free(SESSION *S)
+{
+    if (!S || !S->keydec)
+        return;
+
+    if (S->keydec->pbuf)
+        PDC_sfree(S, S->keydec->pbuf);
+
+    PDC_sfree(S, S->keydec);
+    S->keydec = NULL;
+}
+
+/* The platform passes each buffer it reads, with the time it arrived
+   by PDC_get_clock(). Returns the number of bytes taken, which is less
+   than len only when the decoded keys fill the queue; the rest must
+   be passed again once some are read. Nothing is allocated, except to
+   hold pasted text. Like wgetch(), the decoder is for one thread. */
+
+int PDC_keydec_feed(SESSION *S, const char *buf, int len,
+                    unsigned long now)
+{
+    const unsigned char *p = (const unsigned char *)buf;
+    struct _keydec *d;
+    int i = 0;
+
+    if (!S || !(d = S->keydec) || !buf || len < 0)
+        return ERR;
+
+    /* a sequence left hanging past the delay ended before this, and
+       keeps the arrival of the feed that brought it */
+
+    PDC_keydec_expire(S, now);
+
+    d->arrival = PDC_stats_usec();
+
+    while (i < len && _room(d))
+    {
+        if (d->state == ST_PASTE)
+            i += _paste(S, d, p + i, len - i, now);
+        else
+            _byte(d, p[i++], now);
+    }
+
+    return i;
+}
+
+/* Returns the milliseconds left before an unfinished sequence must be
+   resolved, for the platform's wait, or -1 if there is none. When the
+   time is up, it's resolved, and -1 returned. */
+
+int PDC_keydec_expire(SESSION *S, unsigned long now)
+{
+    struct _keydec *d;
+    long left;
+
+    if (!S || !(d = S->keydec) ||
+        d->state == ST_GROUND || d->state == ST_PASTE)
+        return -1;
+
+    left = (long)(d->since + S->escdelay - now);
+
+    if (left > 0)
+        return (int)left;
+
+    if (!_room(d))
+        return 0;
+
+    _expire(d, now);
+
+    return -1;
+}
+
+/* Take the next key for PDC_get_key(), setting SP->key_code, the
+   modifiers, the key time and, for KEY_MOUSE, the mouse status.
+   Returns FALSE if there is none. */
+
+bool PDC_keydec_get(SESSION *S, int *key)
+{
+    struct _keydec *d;
+    struct _keyev *ev;
+
+    if (!S || !(d = S->keydec) || d->head == d->tail)
+        return FALSE;
+
+    ev = d->q + (d->head++ & (PDC_KEYDEC_QUEUE - 1));
+
+    *key = ev->key;
+    S->SP->key_code = ev->special;
+    S->key_time = ev->time;
+    S->key_arrival = ev->arrival;
+
+    if (S->SP->save_key_modifiers)
+        S->key_modifiers = ev->modifiers;
+
+    if (ev->special && ev->key == KEY_MOUSE)
+        S->mouse_status = ev->mouse;
+
+    /* the paste's text goes out now, in its place among the keys */
+
+    if (ev->special && ev->key == KEY_PASTE && ev->paste)
+    {
+        PDC_paste_add(S, d->pbuf, ev->paste);
+
+        d->plen -= ev->paste;
+        d->pdone -= ev->paste;
+        memmove(d->pbuf, d->pbuf + ev->paste, d->plen);
+    }
+
+    return TRUE;
+}
+
+/* for PDC_check_key() */
+
+bool PDC_keydec_pending(SESSION *S)
+{
+    return S && S->keydec && S->keydec->head != S->keydec->tail;
+}
+
+/* flushinp(): drop the decoded keys, and any sequence in progress */
+
+void PDC_keydec_flush(SESSION *S)
+{
+    struct _keydec *d;
+
+    if (!S || !(d = S->keydec))
+        return;
+
+    d->head = d->tail;
+    d->state = ST_GROUND;
+    d->plen = d->pdone = 0;
+}
+
+int set_escdelay(SESSION *S, int ms)
+{
+    PDC_LOG(("set_escdelay() - called: ms %d\n", ms));
+
+    if (!S || ms < 0)
+        return ERR;
+
+    S->escdelay = ms;
+
+    return OK;
+}
+
+int get_escdelay(SESSION *S)
+{
+    PDC_LOG(("get_escdelay() - called\n"));
+
+    if (!S)
+        return ERR;
+
+    return S->escdelay;
+}
+
+unsigned long PDC_get_key_time(SESSION *S)
+{
+    PDC_LOG(("PDC_get_key_time() - called\n"));
+
+    if (!S)
+        return 0;
+
+    return S->key_time;
+}
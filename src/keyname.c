@@ -97,13 +97,30 @@ const char *keyname(int key)
         "SHF_PADMINUS", "SHF_UP", "SHF_DOWN", "SHF_IC", "SHF_DC",
         "KEY_MOUSE", "KEY_SHIFT_L", "KEY_SHIFT_R", "KEY_CONTROL_L",
         "KEY_CONTROL_R", "KEY_ALT_L", "KEY_ALT_R", "KEY_RESIZE",
-        "KEY_SUP", "KEY_SDOWN"
+        "KEY_SUP", "KEY_SDOWN", "KEY_PASTE"
+    };
+
+    /* unctrl() of each ASCII code; constant, so safe across threads */
+
+    static const char *ascii_name[] =
+    {
+        "^@", "^A", "^B", "^C", "^D", "^E", "^F", "^G", "^H", "^I", "^J", "^K",
+        "^L", "^M", "^N", "^O", "^P", "^Q", "^R", "^S", "^T", "^U", "^V", "^W",
+        "^X", "^Y", "^Z", "^[", "^\\", "^]", "^^", "^_", " ", "!", "\"", "#",
+        "$", "%", "&", "'", "(", ")", "*", "+", ",", "-", ".", "/",
+        "0", "1", "2", "3", "4", "5", "6", "7", "8", "9", ":", ";",
+        "<", "=", ">", "?", "@", "A", "B", "C", "D", "E", "F", "G",
+        "H", "I", "J", "K", "L", "M", "N", "O", "P", "Q", "R", "S",
+        "T", "U", "V", "W", "X", "Y", "Z", "[", "\\", "]", "^", "_",
+        "`", "a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k",
+        "l", "m", "n", "o", "p", "q", "r", "s", "t", "u", "v", "w",
+        "x", "y", "z", "{", "|", "}", "~", "^?"
     };
 
     PDC_LOG(("keyname() - called: key %d\n", key));
 
     if ((key >= 0) && (key < 0x80))
-        return unctrl((chtype)key);
+        return ascii_name[key];
 
     return has_key(key) ? key_name[key - KEY_MIN] : "UNKNOWN KEY";
 }
@@ -0,0 +1,205 @@
+/* Public Domain Curses */
+
+#include "curspriv.h"
+
+RCSID("$Id: keyring.c,v 1.1 $")
+
+/*man-start**************************************************************
+
+  Name:                                                         keyring
+
+  Synopsis:
+        int keyring_push(SESSION *S, int key, bool special);
+
+  Description:
+        Each session has a queue of keys that one other thread may
+        feed, such as the one reading the session's network
+        connection. keyring_push() adds a key to it; special is TRUE
+        for function keys (KEY_*), as PDC_get_key() reports them.
+        wgetch() takes keys from the queue before asking the platform,
+        and is woken when one is pushed while it sleeps.
+
+        The queue takes no locks: keyring_push() must only ever be
+        called from one thread at a time, and the keys only read by
+        the thread calling wgetch(). A push costs a system call only
+        when wgetch() is asleep.
+
+  Return Value:
+        keyring_push() returns ERR if the queue is full (it holds
+        PDC_KEYRING_SIZE keys) or not set up, and OK otherwise.
+
+  Portability                                X/Open    BSD    SYS V
+        keyring_push                            -       -       -
+
+**man-end****************************************************************/
+
+#include <stdatomic.h>
+
+#define PDC_KEYRING_SIZE 256     /* a power of two */
+#define PDC_KEYRING_PAD  64      /* keep the indices on their own cache
+                                    lines */
+
+struct _keyring
+{
+    atomic_uint head;            /* next to read; written by wgetch() */
+    char pad1[PDC_KEYRING_PAD - sizeof(atomic_uint)];
+    atomic_uint tail;            /* next to write; written by the pusher */
+    char pad2[PDC_KEYRING_PAD - sizeof(atomic_uint)];
+    atomic_bool sleeping;        /* wgetch() is in, or near, PDC_wait_key() */
+    atomic_bool woken;           /* wgetch_wake() was called */
+    int key[PDC_KEYRING_SIZE];
+    bool special[PDC_KEYRING_SIZE];
+    unsigned long time[PDC_KEYRING_SIZE];   /* PDC_stats_usec() */
+};
+
+int PDC_keyring_init(SESSION *S)
+{
+    struct _keyring *q;
+
+    if (!S)
+        return ERR;
+
+    if (S->keyring)
+        return OK;
+
+    if (!(q = PDC_scalloc(S, 1, sizeof(struct _keyring))))
+        return ERR;
+
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->sleeping, FALSE);
+    atomic_init(&q->woken, FALSE);
+
+    S->keyring = q;
+
+    return OK;
+}
+
+void PDC_keyring_free(SESSION *S)
+{
+    if (!S || !S->keyring)
+        return;
+
+    PDC_sfree(S, S->keyring);
+    S->keyring = NULL;
+}
+
+int keyring_push(SESSION *S, int key, bool special)
+{
+    struct _keyring *q;
+    unsigned head, tail;
+
+    PDC_LOG(("keyring_push() - called: key %d\n", key));
+
+    if (!S || !(q = S->keyring))
+        return ERR;
+
+    head = atomic_load_explicit(&q->head, memory_order_acquire);
+    tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+
+    if (tail - head == PDC_KEYRING_SIZE)
+        return ERR;
+
+    q->key[tail & (PDC_KEYRING_SIZE - 1)] = key;
+    q->special[tail & (PDC_KEYRING_SIZE - 1)] = special;
+    q->time[tail & (PDC_KEYRING_SIZE - 1)] = PDC_stats_usec();
+
+    /* the store of tail and the load of sleeping pair with the reverse
+       in PDC_keyring_sleep(), so one side always sees the other */
+
+    atomic_store(&q->tail, tail + 1);
+
+    if (atomic_load(&q->sleeping))
+        PDC_wake(S);
+
+    return OK;
+}
+
+/* Take the next key, setting SP->key_code as PDC_get_key() does, and
+   the time it was pushed. Returns FALSE if there is none. */
+
+bool PDC_keyring_pop(SESSION *S, int *key)
+{
+    struct _keyring *q = S->keyring;
+    unsigned head, tail;
+
+    if (!q)
+        return FALSE;
+
+    tail = atomic_load_explicit(&q->tail, memory_order_acquire);
+    head = atomic_load_explicit(&q->head, memory_order_relaxed);
+
+    if (head == tail)
+        return FALSE;
+
+    *key = q->key[head & (PDC_KEYRING_SIZE - 1)];
+    S->SP->key_code = q->special[head & (PDC_KEYRING_SIZE - 1)];
+    S->key_arrival = q->time[head & (PDC_KEYRING_SIZE - 1)];
+
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+
+    return TRUE;
+}
+
+/* for typeahead(): is a key waiting? */
+
+bool PDC_keyring_pending(SESSION *S)
+{
+    struct _keyring *q = S->keyring;
+
+    return q && atomic_load_explicit(&q->tail, memory_order_acquire) !=
+                atomic_load_explicit(&q->head, memory_order_relaxed);
+}
+
+/* flushinp(): drop all the keys pushed so far */
+
+void PDC_keyring_flush(SESSION *S)
+{
+    struct _keyring *q = S->keyring;
+
+    if (q)
+        atomic_store_explicit(&q->head,
+            atomic_load_explicit(&q->tail, memory_order_acquire),
+            memory_order_release);
+}
+
+/* Called by wgetch() before it sleeps; returns FALSE if a key came in
+   meanwhile, and it shouldn't. PDC_keyring_awake() must follow. */
+
+bool PDC_keyring_sleep(SESSION *S)
+{
+    struct _keyring *q = S->keyring;
+
+    if (!q)
+        return TRUE;
+
+    atomic_store(&q->sleeping, TRUE);
+
+    return atomic_load(&q->tail) ==
+           atomic_load_explicit(&q->head, memory_order_relaxed);
+}
+
+void PDC_keyring_awake(SESSION *S)
+{
+    if (S->keyring)
+        atomic_store(&S->keyring->sleeping, FALSE);
+}
+
+/* Set by wgetch_wake(), so that a PDC_WAIT_WOKEN left over from a push
+   isn't taken for one */
+
+int PDC_keyring_wake(SESSION *S)
+{
+    if (S->keyring)
+        atomic_store(&S->keyring->woken, TRUE);
+
+    return PDC_wake(S);
+}
+
+bool PDC_keyring_woken(SESSION *S)
+{
+    if (!S->keyring)
+        return TRUE;
+
+    return atomic_exchange(&S->keyring->woken, FALSE);
+}
@@ -252,9 +252,10 @@
 #define KEY_RESIZE    0x222  /* Window resize */
 #define KEY_SUP       0x223  /* Shifted up arrow */
 #define KEY_SDOWN     0x224  /* Shifted down arrow */
+#define KEY_PASTE     0x225  /* Bracketed paste; see get_paste() */
 
 #define KEY_MIN       KEY_BREAK      /* Minimum curses key value */
-#define KEY_MAX       KEY_SDOWN      /* Maximum curses key */
+#define KEY_MAX       KEY_PASTE      /* Maximum curses key */
 
 #define KEY_F(n)      (KEY_F0 + (n))
 
@@ -0,0 +1,146 @@
+/* Public Domain Curses */
+
+#include "curspriv.h"
+
+RCSID("$Id: memory.c,v 1.1 $")
+
+/*man-start**************************************************************
+
+  Name:                                                         memory
+
+  Synopsis:
+        unsigned long session_memory(SESSION *S);
+        int session_memory_limit(SESSION *S, unsigned long soft,
+                                 unsigned long hard);
+
+  Description:
+        The memory allocated for a session is charged to it: its
+        windows and pads and their lines, its panels with their lists
+        of the panels obscuring them and their saved layers, the panel
+        map, the soft label keys, the timers, the key queue and
+        decoder, the paste buffer, the trace ring and the state of the
+        doupdate() threads. The platform's SCREEN, reactors and
+        schedulers are not charged. session_memory() returns the bytes
+        charged to S, counting a few bytes of bookkeeping for each
+        block.
+
+        session_memory_limit() limits the charge, so that one session
+        can't take the memory of a server. Once it is over soft, no
+        window, pad or panel can be made or resized for S: newwin(),
+        newpad(), subwin(), dupwin(), new_panel(), wresize(),
+        resize_term() and the like fail. The allocations that keep the
+        existing ones working still go on, up to hard; past that, every
+        allocation fails, as if memory had run out. A limit of 0 is
+        none. A limit below the present charge applies from the next
+        allocation.
+
+  Return Value:
+        session_memory() returns 0 if S is NULL. session_memory_limit()
+        returns ERR if S is NULL or soft is over a non-zero hard, and
+        OK otherwise.
+
+  Portability                                X/Open    BSD    SYS V
+        session_memory                          -       -       -
+        session_memory_limit                    -       -       -
+
+**man-end****************************************************************/
+
+#include <limits.h>
+
+/* in front of each block, keeping its alignment */
+
+union _memhead
+{
+    unsigned long size;         /* of the block, with this */
+    long double ld;
+    void *ptr;
+};
+
+unsigned long session_memory(SESSION *S)
+{
+    PDC_LOG(("session_memory() - called\n"));
+
+    return S ? S->mem_used : 0;
+}
+
+int session_memory_limit(SESSION *S, unsigned long soft, unsigned long hard)
+{
+    PDC_LOG(("session_memory_limit() - called: soft %lu hard %lu\n",
+             soft, hard));
+
+    if (!S || (hard && soft > hard))
+        return ERR;
+
+    S->mem_soft = soft;
+    S->mem_hard = hard;
+
+    return OK;
+}
+
+static void *_charge(SESSION *S, union _memhead *h, unsigned long total)
+{
+    if (!h)
+        return NULL;
+
+    h->size = total;
+
+    S->mem_used += total;
+    S->stats.allocs++;
+    S->stats.alloc_bytes += total;
+
+    return h + 1;
+}
+
+static bool _over(SESSION *S, unsigned long total)
+{
+    return S->mem_hard && S->mem_used + total > S->mem_hard;
+}
+
+/* PDC_malloc(), PDC_calloc() and PDC_free() for memory charged to S.
+   Only the thread running S may call them. */
+
+void *PDC_smalloc(SESSION *S, unsigned size)
+{
+    unsigned long total = sizeof(union _memhead) + (unsigned long)size;
+
+    if (size > UINT_MAX - sizeof(union _memhead) || _over(S, total))
+        return NULL;
+
+    return _charge(S, PDC_malloc(total), total);
+}
+
+void *PDC_scalloc(SESSION *S, unsigned nmemb, unsigned size)
+{
+    unsigned long total;
+
+    if (size && nmemb > (UINT_MAX - sizeof(union _memhead)) / size)
+        return NULL;
+
+    total = sizeof(union _memhead) + (unsigned long)nmemb * size;
+
+    if (_over(S, total))
+        return NULL;
+
+    return _charge(S, PDC_calloc(1, total), total);
+}
+
+void PDC_sfree(SESSION *S, void *ptr)
+{
+    union _memhead *h;
+
+    if (!ptr)
+        return;
+
+    h = (union _memhead *)ptr - 1;
+
+    S->mem_used -= h->size;
+
+    PDC_free(h);
+}
+
+/* Is S over its soft limit, so that no window or panel may be made? */
+
+bool PDC_mem_full(SESSION *S)
+{
+    return S->mem_soft && S->mem_used > S->mem_soft;
+}
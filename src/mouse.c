@@ -24,6 +24,7 @@ RCSID("$Id: mouse.c,v 1.45 2008/07/13 16:08:18 wmcbrine Exp $")
         bool mouse_trafo(int *y, int *x, bool to_screen);
         mmask_t mousemask(mmask_t mask, mmask_t *oldmask);
         int nc_getmouse(MEVENT *event);
+        int nc_getmouse_all(MEVENT *events, int max);
         int ungetmouse(MEVENT *event);
 
   Description:
@@ -125,10 +126,26 @@ RCSID("$Id: mouse.c,v 1.45 2008/07/13 16:08:18 wmcbrine Exp $")
         code. nc_getmouse() calls request_mouse_pos(), which (not
         getmouse()) is the classic equivalent.
 
-        ungetmouse() is the mouse equivalent of ungetch(). However,
-        PDCurses doesn't maintain a queue of mouse events; only one can
-        be pushed back, and it can overwrite or be overwritten by real
-        mouse events.
+        Mouse events wait in a queue of PDC_MOUSEQ_SIZE (16) until
+        they're read, each returned by getch() as one KEY_MOUSE. A
+        move, or a turn of the wheel, that comes before the last event
+        in the queue has been read is merged into it, if it has the
+        same buttons: a move just updates the position, and wheel
+        notches are counted in the z member of the MEVENT. When the
+        queue is full, the oldest move or wheel event is dropped to
+        make room, so that clicks are kept; events already returned as
+        KEY_MOUSE are never dropped. request_mouse_pos() and
+        nc_getmouse() take the event for the last KEY_MOUSE returned;
+        called again, they give the same one.
+
+        nc_getmouse_all() takes up to max events from the queue at
+        once, including any not yet returned as KEY_MOUSE, and returns
+        the number taken. A program that handles a KEY_MOUSE this way
+        sees no further KEY_MOUSE for the events it took.
+
+        ungetmouse() is the mouse equivalent of ungetch(). It puts the
+        event at the head of the queue; only one can be pushed back
+        until it's read.
 
   Portability                                X/Open    BSD    SYS V
         mouse_set                               -       -      4.0
@@ -145,13 +162,109 @@ RCSID("$Id: mouse.c,v 1.45 2008/07/13 16:08:18 wmcbrine Exp $")
         mouse_trafo                             -       -       -
         mousemask                               -       -       -
         nc_getmouse                             -       -       -
+        nc_getmouse_all                         -       -       -
         ungetmouse                              -       -       -
 
 **man-end****************************************************************/
 
 #include <string.h>
 
+#define _MOUSE_MOTION (PDC_MOUSE_MOVED | PDC_MOUSE_POSITION | \
+                       PDC_MOUSE_WHEEL_UP | PDC_MOUSE_WHEEL_DOWN)
 
+/* may b be merged into a, the last unread event? */
+
+static bool _mergeable(const MOUSE_STATUS *a, const MOUSE_STATUS *b)
+{
+    return (b->changes & _MOUSE_MOTION) && a->changes == b->changes &&
+           !memcmp(a->button, b->button, sizeof(a->button));
+}
+
+static void _mouse_drop(SESSION *S, int n)
+{
+    int i;
+
+    for (i = n; i < S->mouseq_len - 1; i++)
+        S->mouseq[(S->mouseq_head + i) % PDC_MOUSEQ_SIZE] =
+            S->mouseq[(S->mouseq_head + i + 1) % PDC_MOUSEQ_SIZE];
+
+    S->mouseq_len--;
+
+    if (n < S->mouseq_told)
+        S->mouseq_told--;
+}
+
+/* Queue S->mouse_status, as reported by the platform and passed by
+   the filters in wgetch() */
+
+void PDC_mouse_push(SESSION *S)
+{
+    MOUSE_STATUS *ms = &S->mouse_status;
+    struct mouseev *ev;
+    int i;
+
+    if (S->mouseq_len)
+    {
+        ev = S->mouseq + (S->mouseq_head + S->mouseq_len - 1) %
+             PDC_MOUSEQ_SIZE;
+
+        if (_mergeable(&ev->status, ms))
+        {
+            ev->status.x = ms->x;
+            ev->status.y = ms->y;
+
+            if (ms->changes & (PDC_MOUSE_WHEEL_UP|PDC_MOUSE_WHEEL_DOWN))
+                ev->ticks++;
+
+            return;
+        }
+    }
+
+    if (S->mouseq_len == PDC_MOUSEQ_SIZE)
+    {
+        /* drop the oldest move or wheel event, or failing that, the
+           oldest event; but not one already returned as KEY_MOUSE, as
+           request_mouse_pos() must still give it. If all of them
+           were, this one is lost. */
+
+        if (S->mouseq_told == S->mouseq_len)
+            return;
+
+        for (i = S->mouseq_told; i < S->mouseq_len; i++)
+            if (S->mouseq[(S->mouseq_head + i) %
+                          PDC_MOUSEQ_SIZE].status.changes & _MOUSE_MOTION)
+                break;
+
+        _mouse_drop(S, (i < S->mouseq_len) ? i : S->mouseq_told);
+    }
+
+    ev = S->mouseq + (S->mouseq_head + S->mouseq_len) % PDC_MOUSEQ_SIZE;
+    ev->status = *ms;
+    ev->ticks = 1;
+
+    S->mouseq_len++;
+}
+
+static bool _mouse_pop(SESSION *S)
+{
+    struct mouseev *ev;
+
+    if (!S->mouseq_len)
+        return FALSE;
+
+    ev = S->mouseq + S->mouseq_head;
+
+    S->Mouse_status = ev->status;
+    S->mouse_ticks = ev->ticks;
+
+    S->mouseq_head = (S->mouseq_head + 1) % PDC_MOUSEQ_SIZE;
+    S->mouseq_len--;
+
+    if (S->mouseq_told)
+        S->mouseq_told--;
+
+    return TRUE;
+}
 
 int mouse_set(SESSION *S, unsigned long mbe)
 {
@@ -206,7 +319,16 @@ int request_mouse_pos(SESSION *S)
     if (!S)
         return ERR;
 
-    S->Mouse_status = S->mouse_status;
+    /* the event for the last KEY_MOUSE, if not taken yet; with none
+       queued, the latest state */
+
+    if (S->mouseq_told)
+        _mouse_pop(S);
+    else if (!S->mouseq_len)
+    {
+        S->Mouse_status = S->mouse_status;
+        S->mouse_ticks = 1;
+    }
 
     return OK;
 }
@@ -344,25 +466,20 @@ mmask_t mousemask(SESSION *S, mmask_t mask, mmask_t *oldmask)
     return S->SP->_trap_mbe;
 }
 
-int nc_getmouse(SESSION *S, MEVENT *event)
+/* Mouse_status as an MEVENT */
+
+static void _mevent(SESSION *S, MEVENT *event)
 {
     int i;
     mmask_t bstate = 0;
 
-    PDC_LOG(("nc_getmouse() - called\n"));
-
-    if (!S || !event)
-        return ERR;
-
-    S->mouse_ungot= FALSE;
-
-    request_mouse_pos(S);
-
     event->id = 0;
 
     event->x = S->Mouse_status.x;
     event->y = S->Mouse_status.y;
-    event->z = 0;
+    event->z = (S->Mouse_status.changes &
+                (PDC_MOUSE_WHEEL_UP|PDC_MOUSE_WHEEL_DOWN)) ?
+               S->mouse_ticks : 0;
 
     for (i = 0; i < 3; i++)
     {
@@ -399,10 +516,40 @@ int nc_getmouse(SESSION *S, MEVENT *event)
     /* extra filter pass -- mainly for button modifiers */
 
     event->bstate = bstate & S->SP->_trap_mbe;
+}
+
+int nc_getmouse(SESSION *S, MEVENT *event)
+{
+    PDC_LOG(("nc_getmouse() - called\n"));
+
+    if (!S || !event)
+        return ERR;
+
+    S->mouse_ungot = FALSE;
+
+    request_mouse_pos(S);
+    _mevent(S, event);
 
     return OK;
 }
 
+int nc_getmouse_all(SESSION *S, MEVENT *events, int max)
+{
+    int n = 0;
+
+    PDC_LOG(("nc_getmouse_all() - called: max %d\n", max));
+
+    if (!S || !events || max < 1)
+        return ERR;
+
+    S->mouse_ungot = FALSE;
+
+    while (n < max && _mouse_pop(S))
+        _mevent(S, events + n++);
+
+    return n;
+}
+
 int ungetmouse(SESSION *S, MEVENT *event)
 {
     int i;
@@ -410,7 +557,8 @@ int ungetmouse(SESSION *S, MEVENT *event)
 
     PDC_LOG(("ungetmouse() - called\n"));
 
-    if (!S || !event || S->mouse_ungot)
+    if (!S || !event || S->mouse_ungot ||
+        S->mouseq_len == PDC_MOUSEQ_SIZE)
         return ERR;
 
     S->mouse_ungot = TRUE;
@@ -454,5 +602,15 @@ int ungetmouse(SESSION *S, MEVENT *event)
     else if (bstate & BUTTON5_PRESSED)
         S->mouse_status.changes |= PDC_MOUSE_WHEEL_DOWN;
 
+    /* at the head of the queue, already returned as the KEY_MOUSE
+       pushed back below */
+
+    S->mouseq_head = (S->mouseq_head + PDC_MOUSEQ_SIZE - 1) %
+                     PDC_MOUSEQ_SIZE;
+    S->mouseq[S->mouseq_head].status = S->mouse_status;
+    S->mouseq[S->mouseq_head].ticks = 1;
+    S->mouseq_len++;
+    S->mouseq_told++;
+
     return ungetch(S, KEY_MOUSE);
 }
@@ -50,5 +50,7 @@ int wmove(SESSION *S, WINDOW *win, int y, int x)
     win->_curx = x;
     win->_cury = y;
 
+    PDC_TRACE(S, PDC_TR_WMOVE, win, y, x, 0);
+
     return OK;
 }
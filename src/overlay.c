@@ -46,9 +46,9 @@ RCSID("$Id: overlay.c,v 1.36 2008/07/14 12:35:23 wmcbrine Exp $")
 /* Thanks to Andreas Otte <venn@@uni-paderborn.de> for the
    corrected overlay()/overwrite() behavior. */
 
-static int _copy_win(const WINDOW *src_w, WINDOW *dst_w, int src_tr,
-                     int src_tc, int src_br, int src_bc, int dst_tr,
-                     int dst_tc, bool overlay)
+static int _copy_win(SESSION *S, const WINDOW *src_w, WINDOW *dst_w,
+                     int src_tr, int src_tc, int src_br, int src_bc,
+                     int dst_tr, int dst_tc, bool overlay)
 {
     int col, line, y1, fc;
     short *minchng, *maxchng;
@@ -58,7 +58,9 @@ static int _copy_win(const WINDOW *src_w, WINDOW *dst_w, int src_tr,
     int xdiff = src_bc - src_tc;
     int ydiff = src_br - src_tr;
 
-    if (!src_w || !dst_w)
+    /* a virtual pad's lines belong to its render() */
+
+    if (!src_w || !dst_w || (dst_w->_flags & _VPAD))
         return ERR;
 
     minchng = dst_w->_firstch;
@@ -83,6 +85,7 @@ static int _copy_win(const WINDOW *src_w, WINDOW *dst_w, int src_tr,
                 !((*w1ptr & A_CHARTEXT) == ' ' && overlay))
             {
                 *w2ptr = *w1ptr;
+                S->stats.cells_written++;
 
                 if (fc == _NO_CHANGE)
                     fc = col + dst_tc;
@@ -122,7 +125,7 @@ int overlay(SESSION *S, const WINDOW *src_w, WINDOW *dst_w)
 
     PDC_LOG(("overlay() - called\n"));
 
-    if (!src_w || !dst_w)
+    if (!S || !src_w || !dst_w)
         return ERR;
 
     first_col = max(dst_w->_begx, src_w->_begx);
@@ -166,7 +169,7 @@ int overlay(SESSION *S, const WINDOW *src_w, WINDOW *dst_w)
         src_start_y = 0;
     }
 
-    return _copy_win(src_w, dst_w, src_start_y, src_start_x,
+    return _copy_win(S, src_w, dst_w, src_start_y, src_start_x,
                      src_start_y + ydiff, src_start_x + xdiff,
                      dst_start_y, dst_start_x, TRUE);
 }
@@ -179,7 +182,7 @@ int overwrite(SESSION *S, const WINDOW *src_w, WINDOW *dst_w)
 
     PDC_LOG(("overwrite() - called\n"));
 
-    if (!src_w || !dst_w)
+    if (!S || !src_w || !dst_w)
         return ERR;
 
     first_col = max(dst_w->_begx, src_w->_begx);
@@ -223,7 +226,7 @@ int overwrite(SESSION *S, const WINDOW *src_w, WINDOW *dst_w)
         src_start_y = 0;
     }
 
-    return _copy_win(src_w, dst_w, src_start_y, src_start_x,
+    return _copy_win(S, src_w, dst_w, src_start_y, src_start_x,
                      src_start_y + ydiff, src_start_x + xdiff,
                      dst_start_y, dst_start_x, FALSE);
 }
@@ -237,7 +240,7 @@ int copywin(SESSION *S, const WINDOW *src_w, WINDOW *dst_w, int src_tr, int src_
 
     PDC_LOG(("copywin() - called\n"));
 
-    if (!src_w || !dst_w || dst_w == S->curscr || dst_br > dst_w->_maxy
+    if (!S || !src_w || !dst_w || dst_w == S->curscr || dst_br > dst_w->_maxy
         || dst_bc > dst_w->_maxx || dst_tr < 0 || dst_tc < 0)
         return ERR;
 
@@ -252,6 +255,6 @@ int copywin(SESSION *S, const WINDOW *src_w, WINDOW *dst_w, int src_tr, int src_
     src_end_y = src_tr + min_rows;
     src_end_x = src_tc + min_cols;
 
-    return _copy_win(src_w, dst_w, src_tr, src_tc, src_end_y, src_end_x,
+    return _copy_win(S, src_w, dst_w, src_tr, src_tc, src_end_y, src_end_x,
                      dst_tr, dst_tc, overlay);
 }
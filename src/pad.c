@@ -10,6 +10,10 @@ RCSID("$Id: pad.c,v 1.50 2008/07/14 12:22:13 wmcbrine Exp $")
 
   Synopsis:
         WINDOW *newpad(int nlines, int ncols);
+        WINDOW *newringpad(int nlines, int ncols);
+        WINDOW *newvpad(int nrows, int ncols, int ncache,
+                        void (*render)(WINDOW *, int, chtype *, void *),
+                        void *arg);
         WINDOW *subpad(WINDOW *orig, int nlines, int ncols,
                        int begy, int begx);
         int prefresh(WINDOW *win, int py, int px, int sy1, int sx1,
@@ -19,6 +23,13 @@ RCSID("$Id: pad.c,v 1.50 2008/07/14 12:22:13 wmcbrine Exp $")
         int pechochar(WINDOW *pad, chtype ch);
         int pecho_wchar(WINDOW *pad, const cchar_t *wch);
 
+        int ringpad_newline(WINDOW *pad);
+        int ringpad_addline(WINDOW *pad, const char *str);
+        int ringpad_follow(WINDOW *pad, bool bf);
+
+        int vpad_invalidate(WINDOW *pad, int row, int n);
+        int vpad_set_rows(WINDOW *pad, int nrows);
+
   Description:
         A pad is a special kind of window, which is not restricted by
         the screen size, and is not necessarily associated with a
@@ -49,10 +60,67 @@ RCSID("$Id: pad.c,v 1.50 2008/07/14 12:22:13 wmcbrine Exp $")
         to be displayed; (sy1, sx1) and (sy2, sx2) describe the screen
         rectangle that will contain the selected part of the pad.
 
+        Like wnoutrefresh(), pnoutrefresh() only copies what has
+        changed: if the viewport is the same as on the previous call,
+        just the touched parts of the visible pad lines are copied. If
+        the viewport has moved, every visible line is compared against
+        the virtual screen, and only the cells that differ are marked
+        for update. When a full-width viewport has only moved up or
+        down by no more than half its height, the virtual screen is
+        shifted to match, and doupdate() scrolls that region of the
+        physical screen instead of redrawing it. As with overlapping
+        windows, if something else has been drawn over the pad's screen
+        rectangle, touchwin() the pad before refreshing it.
+
         pechochar() is functionally equivalent to addch() followed by
         a call to prefresh(), with the last-used coordinates and
         dimensions. pecho_wchar() is the wide-character version.
 
+        newringpad() creates a pad of nlines lines that works like the
+        scrollback of a terminal: its lines form a ring, so adding a
+        line at the bottom drops the oldest line off the top without
+        moving any of the others. This costs the same however long the
+        pad is, which makes ring pads suited to log panes. Line 0 is
+        always the oldest line kept. A ring pad can't be resized, and
+        can't have subpads or subwindows.
+
+        ringpad_newline() discards the top line of a ring pad, adds a
+        blank line at the bottom, and moves the cursor to its start.
+        ringpad_addline() does the same, then adds str there; if str
+        is longer than a line, it continues on further new lines when
+        scrollok() is set for the pad, and is truncated otherwise.
+        With scrollok() set, wscrl() and the automatic scroll at the
+        bottom of the pad also add lines this way.
+
+        ringpad_follow() switches "follow tail" mode on (bf TRUE) or off
+        for a ring pad. In this mode, pnoutrefresh() ignores py and
+        shows the last lines of the pad. When a full-width viewport
+        follows the tail, only the lines added since the last refresh
+        are copied, and the rest are moved by a scroll of the screen.
+        Otherwise, the lines shown stay in view as lines are added, as
+        long as py is adjusted by the number of lines added.
+
+        newvpad() creates a virtual pad: a pad nrows lines long whose
+        lines aren't stored, but drawn on demand by render(). Only
+        ncache lines are kept (if ncache is less than LINES, LINES is
+        used), so a virtual pad can front a dataset of any size.
+        pnoutrefresh() asks for each line of the viewport that isn't in
+        the cache, by calling render() with the pad, the line number,
+        a line of getmaxx(pad) cells filled with the background, and
+        arg. The least recently shown line makes way for it. The rest
+        of the viewport is copied only as much as pnoutrefresh() would
+        for an ordinary pad. A virtual pad can't be resized or have
+        subpads or subwindows, and can't be written to: waddch(),
+        waddchnstr(), werase() and the other calls that change its
+        cells return ERR for it, since what they wrote would be lost
+        when its lines are rendered again. Its background is set with
+        wbkgdset(). getmaxy() gives its cache size, not nrows.
+
+        vpad_invalidate() drops n lines from row onward (n < 0 meaning
+        to the end) from the cache of a virtual pad, so that they'll be
+        rendered again the next time they're shown. vpad_set_rows()
+        changes the number of lines in the dataset.
+
   Return Value:
         All functions return OK on success and ERR on error.
 
@@ -63,12 +131,30 @@ RCSID("$Id: pad.c,v 1.50 2008/07/14 12:22:13 wmcbrine Exp $")
         pnoutrefresh                            Y       -       Y
         pechochar                               Y       -      3.0
         pecho_wchar                             Y
+        newringpad                              -       -       -
+        ringpad_newline                         -       -       -
+        ringpad_addline                         -       -       -
+        ringpad_follow                          -       -       -
+        newvpad                                 -       -       -
+        vpad_invalidate                         -       -       -
+        vpad_set_rows                           -       -       -
 
 **man-end****************************************************************/
 
 #include <string.h>
 
-/* save values for pechochar() */
+/* the dataset behind a virtual pad, and which of its lines are held in
+   each line of the pad */
+
+struct _vpad
+{
+    int nrows;                      /* lines in the dataset */
+    void (*render)(SESSION *, WINDOW *, int, chtype *, void *);
+    void *arg;
+    unsigned long clock;            /* ticks once per line shown */
+    unsigned long *used;            /* when each cache line was shown */
+    int *row;                       /* dataset line held, or -1 */
+};
 
 
 WINDOW *newpad(SESSION *S, int nlines, int ncols)
@@ -101,6 +187,235 @@ WINDOW *newpad(SESSION *S, int nlines, int ncols)
     return win;
 }
 
+WINDOW *newringpad(SESSION *S, int nlines, int ncols)
+{
+    WINDOW *win;
+
+    PDC_LOG(("newringpad() - called: lines=%d cols=%d\n", nlines, ncols));
+
+    if (!S || nlines < 1)
+        return (WINDOW *)NULL;
+
+    /* the line arrays are twice the pad's height; the pad sees a window
+       onto them that slides down one entry for each line added */
+
+    if ( !(win = PDC_makenew(S, 2 * nlines, ncols, -1, -1)) )
+        return (WINDOW *)NULL;
+
+    win->_maxy = nlines;
+    win->_bmarg = nlines - 1;
+
+    if ( !(win = PDC_makelines(S, win)) )
+        return (WINDOW *)NULL;
+
+    werase(S, win);
+
+    win->_flags = _PAD | _RINGPAD;
+
+    S->pad_save_pminrow = 0;
+    S->pad_save_pmincol = 0;
+    S->pad_save_sminrow = 0;
+    S->pad_save_smincol = 0;
+    S->pad_save_smaxrow = min(S->LINES, nlines) - 1;
+    S->pad_save_smaxcol = min(S->COLS, ncols) - 1;
+
+    return win;
+}
+
+/* drop the oldest line of a ring pad and recycle it as a blank line at
+   the bottom. Only the entry just past the end of the view needs to be
+   set; when the view reaches the end of the arrays, it's moved back to
+   the start, which happens once every nlines calls. */
+
+int PDC_ring_advance(SESSION *S, WINDOW *win)
+{
+    int nlines = win->_maxy;
+    chtype *line = win->_y[0];
+    chtype blank = win->_bkgd;
+    int i;
+
+    for (i = 0; i < win->_maxx; i++)
+        line[i] = blank;
+
+    S->stats.cells_written += win->_maxx;
+
+    win->_y[nlines] = line;
+    win->_firstch[nlines] = 0;
+    win->_lastch[nlines] = win->_maxx - 1;
+
+    win->_y++;
+    win->_firstch++;
+    win->_lastch++;
+
+    if (++win->_ringhead == nlines)
+    {
+        win->_y -= nlines;
+        win->_firstch -= nlines;
+        win->_lastch -= nlines;
+
+        memcpy(win->_y, win->_y + nlines, nlines * sizeof(chtype *));
+        memcpy(win->_firstch, win->_firstch + nlines, nlines * sizeof(short));
+        memcpy(win->_lastch, win->_lastch + nlines, nlines * sizeof(short));
+
+        win->_ringhead = 0;
+    }
+
+    win->_ringshift++;
+
+    return OK;
+}
+
+int ringpad_newline(SESSION *S, WINDOW *pad)
+{
+    PDC_LOG(("ringpad_newline() - called\n"));
+
+    if (!S || !pad || !(pad->_flags & _RINGPAD))
+        return ERR;
+
+    PDC_ring_advance(S, pad);
+
+    pad->_cury = pad->_maxy - 1;
+    pad->_curx = 0;
+
+    return OK;
+}
+
+int ringpad_addline(SESSION *S, WINDOW *pad, const char *str)
+{
+    PDC_LOG(("ringpad_addline() - called\n"));
+
+    if (ringpad_newline(S, pad) == ERR || !str)
+        return ERR;
+
+    return waddstr(S, pad, str);
+}
+
+int ringpad_follow(SESSION *S, WINDOW *pad, bool bf)
+{
+    PDC_LOG(("ringpad_follow() - called\n"));
+
+    if (!S || !pad || !(pad->_flags & _RINGPAD))
+        return ERR;
+
+    pad->_follow = bf;
+
+    return OK;
+}
+
+WINDOW *newvpad(SESSION *S, int nrows, int ncols, int ncache,
+                void (*render)(SESSION *, WINDOW *, int, chtype *, void *),
+                void *arg)
+{
+    WINDOW *win;
+    struct _vpad *v;
+    int i;
+
+    PDC_LOG(("newvpad() - called: rows=%d cols=%d cache=%d\n",
+             nrows, ncols, ncache));
+
+    if (!S || nrows < 0 || !render)
+        return (WINDOW *)NULL;
+
+    if (ncache < S->LINES)
+        ncache = S->LINES;
+
+    v = PDC_smalloc(S, sizeof(struct _vpad) +
+                   ncache * (sizeof(unsigned long) + sizeof(int)));
+    if (!v)
+        return (WINDOW *)NULL;
+
+    if ( !(win = PDC_makenew(S, ncache, ncols, -1, -1))
+        || !(win = PDC_makelines(S, win)) )
+    {
+        PDC_sfree(S, v);
+        return (WINDOW *)NULL;
+    }
+
+    v->nrows = nrows;
+    v->render = render;
+    v->arg = arg;
+    v->clock = 0;
+    v->used = (unsigned long *)(v + 1);
+    v->row = (int *)(v->used + ncache);
+
+    for (i = 0; i < ncache; i++)
+    {
+        v->used[i] = 0;
+        v->row[i] = -1;
+    }
+
+    win->_vpad = v;
+    win->_flags = _PAD | _VPAD;
+
+    return win;
+}
+
+int vpad_invalidate(SESSION *S, WINDOW *pad, int row, int n)
+{
+    struct _vpad *v;
+    int i;
+
+    PDC_LOG(("vpad_invalidate() - called: row=%d n=%d\n", row, n));
+
+    if (!S || !pad || !(pad->_flags & _VPAD))
+        return ERR;
+
+    v = pad->_vpad;
+
+    for (i = 0; i < pad->_maxy; i++)
+        if (v->row[i] >= row && (n < 0 || v->row[i] < row + n))
+        {
+            v->row[i] = -1;
+            v->used[i] = 0;
+        }
+
+    return OK;
+}
+
+int vpad_set_rows(SESSION *S, WINDOW *pad, int nrows)
+{
+    PDC_LOG(("vpad_set_rows() - called: rows=%d\n", nrows));
+
+    if (!S || !pad || !(pad->_flags & _VPAD) || nrows < 0)
+        return ERR;
+
+    pad->_vpad->nrows = nrows;
+
+    return vpad_invalidate(S, pad, nrows, -1);
+}
+
+/* find the cache line holding a dataset line, rendering it into the
+   least recently shown one if it isn't there; *fresh is set if so */
+
+static chtype *_vpad_line(SESSION *S, WINDOW *w, int row, bool *fresh)
+{
+    struct _vpad *v = w->_vpad;
+    int i, lru = 0;
+
+    for (i = 0; i < w->_maxy; i++)
+    {
+        if (v->row[i] == row)
+        {
+            v->used[i] = ++v->clock;
+            *fresh = FALSE;
+            return w->_y[i];
+        }
+
+        if (v->used[i] < v->used[lru])
+            lru = i;
+    }
+
+    for (i = 0; i < w->_maxx; i++)
+        w->_y[lru][i] = w->_bkgd;
+
+    v->render(S, w, row, w->_y[lru], v->arg);
+    v->row[lru] = row;
+    v->used[lru] = ++v->clock;
+    *fresh = TRUE;
+
+    return w->_y[lru];
+}
+
 WINDOW *subpad(SESSION *S, WINDOW *orig, int nlines, int ncols, int begy, int begx)
 {
     WINDOW *win;
@@ -114,7 +429,7 @@ WINDOW *subpad(SESSION *S, WINDOW *orig, int nlines, int ncols, int begy, int be
     if (!S)
         return (WINDOW *)NULL;
 
-    if (!orig || !(orig->_flags & _PAD))
+    if (!orig || !(orig->_flags & _PAD) || (orig->_flags & (_RINGPAD|_VPAD)))
         return (WINDOW *)NULL;
 
     /* make sure window fits inside the original one */
@@ -174,11 +489,86 @@ int prefresh(SESSION *S, WINDOW *win, int py, int px, int sy1, int sx1, int sy2,
     return OK;
 }
 
+/* copy cols first..last of a pad line to the virtual screen at row
+   sline, column sx1 onward, trimming cells that haven't changed */
+
+static void _copy_line(SESSION *S, const chtype *src, int sline, int sx1,
+                       int first, int last, bool trim)
+{
+    chtype *dest = S->curscr->_y[sline] + sx1;
+
+    if (trim)
+    {
+        while (first <= last && src[first] == dest[first])
+            first++;
+
+        while (last >= first && src[last] == dest[last])
+            last--;
+    }
+
+    if (first > last)
+        return;
+
+    memcpy(dest + first, src + first, (last - first + 1) * sizeof(chtype));
+
+    first += sx1;
+    last += sx1;
+
+    if (S->curscr->_firstch[sline] == _NO_CHANGE
+        || S->curscr->_firstch[sline] > first)
+        S->curscr->_firstch[sline] = first;
+
+    if (last > S->curscr->_lastch[sline])
+        S->curscr->_lastch[sline] = last;
+}
+
+/* if the viewport has only moved vertically, and spans the whole
+   screen width, shift the virtual screen rows to follow it and leave a
+   hint for doupdate(); returns the shift, or 0 if there's none */
+
+static int _scroll_viewport(SESSION *S, WINDOW *w, int py, int sy1, int sy2,
+                            int nlines)
+{
+    int dy = py - w->_pady;
+    int n = (dy > 0) ? dy : -dy;
+    int i, l, start, end, dir;
+    chtype *temp;
+
+    if (!dy || n > (sy2 - sy1 + 1) / 2 || S->scroll_hint_n ||
+        py + (sy2 - sy1) >= nlines ||
+        S->curscr->_clear || w->_sminx != 0 ||
+        w->_smaxx != S->SP->cols - 1 || w->_maxx - w->_padx < S->SP->cols)
+        return 0;
+
+    for (i = sy1; i <= sy2; i++)
+        if (S->curscr->_firstch[i] != _NO_CHANGE)
+            return 0;
+
+    start = (dy > 0) ? sy1 : sy2;
+    end = (dy > 0) ? sy2 : sy1;
+    dir = (dy > 0) ? 1 : -1;
+
+    for (l = 0; l < n; l++)
+    {
+        temp = S->curscr->_y[start];
+
+        for (i = start; i != end; i += dir)
+            S->curscr->_y[i] = S->curscr->_y[i + dir];
+
+        S->curscr->_y[end] = temp;
+    }
+
+    S->scroll_hint_top = sy1;
+    S->scroll_hint_bot = sy2;
+    S->scroll_hint_n = dy;
+
+    return dy;
+}
+
 int pnoutrefresh(SESSION *S, WINDOW *w, int py, int px, int sy1, int sx1, int sy2, int sx2)
 {
-    int num_cols;
-    int sline = sy1;
-    int pline = py;
+    int num_cols, sline, pline, dy, fresh_top, fresh_bot;
+    bool moved;
 
     PDC_LOG(("pnoutrefresh() - called\n"));
 
@@ -197,30 +587,101 @@ int pnoutrefresh(SESSION *S, WINDOW *w, int py, int px, int sy1, int sx1, int sy
     if (sy2 < sy1 || sx2 < sx1)
         return ERR;
 
+    /* the rows compared below must be what was really drawn */
+
+    if (S->flash_state == PDC_FLASH_CELLS)
+        PDC_flash_end(S);
+
+    /* in a ring pad, the lines last shown have moved up by however many
+       lines were added since */
+
+    if (w->_flags & _RINGPAD)
+    {
+        if (w->_follow)
+            py = max(w->_maxy - (sy2 - sy1 + 1), 0);
+
+        w->_pady -= w->_ringshift;
+        w->_ringshift = 0;
+    }
+
     num_cols = min((sx2 - sx1 + 1), (w->_maxx - px));
 
-    while (sline <= sy2)
+    moved = w->_clear || py != w->_pady || px != w->_padx ||
+            sy1 != w->_sminy || sx1 != w->_sminx ||
+            sy2 != w->_smaxy || sx2 != w->_smaxx;
+
+    /* rows uncovered by a scroll hold nothing worth comparing against;
+       the rest already show their pad lines, so only their touched
+       parts need copying */
+
+    dy = 0;
+    fresh_top = fresh_bot = -1;
+
+    if (moved && w->_padx >= 0 && px == w->_padx && sy1 == w->_sminy &&
+        sx1 == w->_sminx && sy2 == w->_smaxy && sx2 == w->_smaxx &&
+        !w->_clear)
+        dy = _scroll_viewport(S, w, py, sy1, sy2,
+                              (w->_flags & _VPAD) ? w->_vpad->nrows : w->_maxy);
+
+    if (dy > 0)
+    {
+        fresh_top = sy2 - dy + 1;
+        fresh_bot = sy2;
+    }
+    else if (dy < 0)
     {
-        if (pline < w->_maxy)
+        fresh_top = sy1;
+        fresh_bot = sy1 - dy - 1;
+    }
+
+    for (sline = sy1, pline = py; sline <= sy2; sline++, pline++)
+    {
+        if (w->_flags & _VPAD)
         {
-            memcpy(S->curscr->_y[sline] + sx1, w->_y[pline] + px,
-                   num_cols * sizeof(chtype));
+            chtype *line;
+            bool fresh;
+
+            if (pline >= w->_vpad->nrows)
+                continue;
+
+            line = _vpad_line(S, w, pline, &fresh);
 
-            if ((S->curscr->_firstch[sline] == _NO_CHANGE)
-                || (S->curscr->_firstch[sline] > sx1))
-                S->curscr->_firstch[sline] = sx1;
+            if (sline >= fresh_top && sline <= fresh_bot)
+                _copy_line(S, line + px, sline, sx1, 0, num_cols - 1, FALSE);
 
-            if (sx2 > S->curscr->_lastch[sline])
-                S->curscr->_lastch[sline] = sx2;
+            else if (fresh || (moved && !dy))
+                _copy_line(S, line + px, sline, sx1, 0, num_cols - 1, TRUE);
 
-            w->_firstch[pline] = _NO_CHANGE; /* updated now */
-            w->_lastch[pline] = _NO_CHANGE;  /* updated now */
+            continue;
         }
 
-        sline++;
-        pline++;
+        if (pline >= w->_maxy)
+            continue;
+
+        if (sline >= fresh_top && sline <= fresh_bot)
+            _copy_line(S, w->_y[pline] + px, sline, sx1, 0, num_cols - 1,
+                       FALSE);
+
+        else if (moved && !dy)
+            _copy_line(S, w->_y[pline] + px, sline, sx1, 0, num_cols - 1,
+                       TRUE);
+
+        else if (w->_firstch[pline] != _NO_CHANGE)
+            _copy_line(S, w->_y[pline] + px, sline, sx1,
+                       max(w->_firstch[pline] - px, 0),
+                       min(w->_lastch[pline] - px, num_cols - 1), TRUE);
+
+        w->_firstch[pline] = _NO_CHANGE; /* updated now */
+        w->_lastch[pline] = _NO_CHANGE;  /* updated now */
     }
 
+    w->_pady = py;
+    w->_padx = px;
+    w->_sminy = sy1;
+    w->_sminx = sx1;
+    w->_smaxy = sy2;
+    w->_smaxx = sx2;
+
     if (w->_clear)
     {
         w->_clear = FALSE;
@@ -15,11 +15,14 @@ RCSID("$Id: panel.c,v 1.8 2008/07/14 12:35:23 wmcbrine Exp $")
         int move_panel(PANEL *pan, int starty, int startx);
         PANEL *new_panel(WINDOW *win);
         PANEL *panel_above(const PANEL *pan);
+        PANEL *panel_at(int *y, int *x);
         PANEL *panel_below(const PANEL *pan);
         int panel_hidden(const PANEL *pan);
+        bool panel_static(const PANEL *pan);
         const void *panel_userptr(const PANEL *pan);
         WINDOW *panel_window(const PANEL *pan);
         int replace_panel(PANEL *pan, WINDOW *win);
+        int set_panel_static(PANEL *pan, bool flag);
         int set_panel_userptr(PANEL *pan, const void *uptr);
         int show_panel(PANEL *pan);
         int top_panel(PANEL *pan);
@@ -65,6 +68,15 @@ RCSID("$Id: panel.c,v 1.8 2008/07/14 12:35:23 wmcbrine Exp $")
         is NULL, this function returns a pointer to the bottom panel in
         the deck.
 
+        panel_at() returns a pointer to the topmost visible panel at
+        the screen-relative coordinates *y, *x, and converts them in
+        place to coordinates relative to that panel's window. If no
+        panel covers the point (i.e., only stdscr is there), it returns
+        NULL and leaves the coordinates unchanged. The lookup goes
+        through a screen-sized map that the panels library rebuilds
+        only after the deck has changed, so it is a constant-time
+        operation -- suitable for routing every mouse report.
+
         panel_below() returns a pointer to the panel in the deck below
         pan, or NULL if pan is the bottom panel. If the value of pan
         passed is NULL, this function returns a pointer to the top panel
@@ -72,6 +84,9 @@ RCSID("$Id: panel.c,v 1.8 2008/07/14 12:35:23 wmcbrine Exp $")
 
         panel_hidden() returns OK if pan is hidden and ERR if it is not.
 
+        panel_static() returns TRUE if pan has been marked static with
+        set_panel_static().
+
         panel_userptr() - Each panel has a user pointer available for
         maintaining relevant information. This function returns a
         pointer to that information previously set up by
@@ -82,6 +97,17 @@ RCSID("$Id: panel.c,v 1.8 2008/07/14 12:35:23 wmcbrine Exp $")
 
         replace_panel() replaces the current window of pan with win.
 
+        set_panel_static() marks pan as static (flag TRUE) or ordinary
+        (flag FALSE). A static panel is one whose window rarely changes
+        -- a frame, a menu or a help box. Once it has been drawn,
+        update_panels() keeps a copy of its cells and, as long as the
+        window has not been touched and the panel has not been moved,
+        replaced or restacked, simply lays that copy back over whatever
+        was redrawn underneath it, instead of touching and recomposing
+        the panel. Changes to a static panel's window are picked up by
+        the next update_panels(), so leave refreshing it to the panels
+        library rather than calling wnoutrefresh() on it directly.
+
         set_panel_userptr() - Each panel has a user pointer available
         for maintaining relevant information. This function sets the
         value of that information.
@@ -108,11 +134,14 @@ RCSID("$Id: panel.c,v 1.8 2008/07/14 12:35:23 wmcbrine Exp $")
         move_panel                              -       -       Y
         new_panel                               -       -       Y
         panel_above                             -       -       Y
+        panel_at                                -       -       -
         panel_below                             -       -       Y
         panel_hidden                            -       -       Y
+        panel_static                            -       -       -
         panel_userptr                           -       -       Y
         panel_window                            -       -       Y
         replace_panel                           -       -       Y
+        set_panel_static                        -       -       -
         set_panel_userptr                       -       -       Y
         show_panel                              -       -       Y
         top_panel                               -       -       Y
@@ -124,6 +153,7 @@ RCSID("$Id: panel.c,v 1.8 2008/07/14 12:35:23 wmcbrine Exp $")
 **man-end****************************************************************/
 
 #include <panel.h>
+#include <string.h>
 
 
 #ifdef PANEL_DEBUG
@@ -200,7 +230,100 @@ static bool _panels_overlapped(PANEL *pan1, PANEL *pan2)
          || (pan2->wstartx >= pan1->wstartx && pan2->wstartx < pan1->wendx));
 }
 
-static void _free_obscure(PANEL *pan)
+/* a static panel's cached layer may stand in for the panel as long as
+   neither its contents nor its geometry have moved on since the layer
+   was taken */
+
+static bool _panel_cached(const PANEL *pan)
+{
+    return pan->is_static && pan->layer &&
+           pan->layer_content == pan->content_gen &&
+           pan->layer_geom == pan->geom_gen &&
+           pan->layer_lines == pan->win->_maxy &&
+           pan->layer_cols == pan->win->_maxx;
+}
+
+static void _free_layer(SESSION *S, PANEL *pan)
+{
+    if (pan->layer)
+        PDC_sfree(S, pan->layer);
+
+    pan->layer = (chtype *)0;
+}
+
+/* copy the panel's window into its layer, once it has been composed */
+
+static void _save_layer(SESSION *S, PANEL *pan)
+{
+    WINDOW *win = pan->win;
+    int y;
+
+    /* wresize() leaves the generations alone, so check the size */
+
+    if (pan->layer_geom != pan->geom_gen ||
+        pan->layer_lines != win->_maxy || pan->layer_cols != win->_maxx)
+        _free_layer(S, pan);
+
+    if (!pan->layer &&
+        !(pan->layer = PDC_smalloc(S, win->_maxy * win->_maxx *
+                                      sizeof(chtype))))
+        return;
+
+    pan->layer_lines = win->_maxy;
+    pan->layer_cols = win->_maxx;
+
+    for (y = 0; y < win->_maxy; y++)
+        memcpy(pan->layer + y * win->_maxx, win->_y[y],
+               win->_maxx * sizeof(chtype));
+
+    pan->layer_content = pan->content_gen;
+    pan->layer_geom = pan->geom_gen;
+}
+
+/* lay the cached cells back over every row of curscr that something
+   beneath the panel has just redrawn; the panels above that share the
+   row are then drawn again, over it */
+
+static void _restore_layer(SESSION *S, PANEL *pan)
+{
+    WINDOW *cur = S->curscr;
+    PANEL *pan2;
+    int ncols = min(pan->wendx - pan->wstartx, pan->layer_cols);
+    int endy = min(pan->wendy, pan->wstarty + pan->layer_lines);
+    int y;
+
+    /* the cells copied must not go over a flash; it ends here */
+
+    if (S->flash_state == PDC_FLASH_CELLS)
+        PDC_flash_end(S);
+
+    for (y = pan->wstarty; y < endy; y++)
+    {
+        if (cur->_firstch[y] == _NO_CHANGE ||
+            cur->_firstch[y] >= pan->wendx || cur->_lastch[y] < pan->wstartx)
+            continue;
+
+        memcpy(cur->_y[y] + pan->wstartx,
+               pan->layer + (y - pan->wstarty) * pan->layer_cols,
+               ncols * sizeof(chtype));
+
+        /* a cached panel above redraws itself from the dirty span */
+
+        for (pan2 = pan->above; pan2; pan2 = pan2->above)
+            if (y >= pan2->wstarty && y < pan2->wendy &&
+                pan2->wstartx < pan->wendx && pan2->wendx > pan->wstartx &&
+                !_panel_cached(pan2))
+                Touchline(S, pan2, y - pan2->wstarty, 1);
+
+        if (cur->_firstch[y] > pan->wstartx)
+            cur->_firstch[y] = pan->wstartx;
+
+        if (cur->_lastch[y] < pan->wendx - 1)
+            cur->_lastch[y] = pan->wendx - 1;
+    }
+}
+
+static void _free_obscure(SESSION *S, PANEL *pan)
 {
     PANELOBS *tobs = pan->obscure;  /* "this" one */
     PANELOBS *nobs;                 /* "next" one */
@@ -208,7 +331,7 @@ static void _free_obscure(PANEL *pan)
     while (tobs)
     {
         nobs = tobs->above;
-        PDC_free((char *)tobs);
+        PDC_sfree(S, (char *)tobs);
         tobs = nobs;
     }
     pan->obscure = (PANELOBS *)0;
@@ -224,7 +347,10 @@ static void _override(SESSION *S, PANEL *pan, int show)
         return;
 
     if (show == 1)
-        Touchpan(S, pan);
+    {
+        if (!_panel_cached(pan))
+            Touchpan(S, pan);
+    }
     else if (!show)
     {
         Touchpan(S, pan);
@@ -236,7 +362,7 @@ static void _override(SESSION *S, PANEL *pan, int show)
 
     while (tobs)
     {
-        if ((pan2 = tobs->pan) != pan)
+        if ((pan2 = tobs->pan) != pan && !_panel_cached(pan2))
             for (y = pan->wstarty; y < pan->wendy; y++)
                 if ((y >= pan2->wstarty) && (y < pan2->wendy) &&
                    ((is_linetouched(S, pan->win, y - pan->wstarty)) ||
@@ -256,12 +382,14 @@ static void _calculate_obscure(SESSION *S)
     if (!S)
         return;
 
+    S->panel_map_stale = TRUE;
+
     pan = S->panel_bottom;
 
     while (pan)
     {
         if (pan->obscure)
-            _free_obscure(pan);
+            _free_obscure(S, pan);
 
         lobs = (PANELOBS *)0;
         pan2 = S->panel_bottom;
@@ -270,7 +398,7 @@ static void _calculate_obscure(SESSION *S)
         {
             if (_panels_overlapped(pan, pan2))
             {
-                if ((tobs = PDC_malloc(sizeof(PANELOBS))) == NULL)
+                if ((tobs = PDC_smalloc(S, sizeof(PANELOBS))) == NULL)
                     return;
 
                 tobs->pan = pan2;
@@ -293,6 +421,48 @@ static void _calculate_obscure(SESSION *S)
     }
 }
 
+/* paint the deck into the lookup map, bottom to top, so that each cell
+   ends up holding the topmost panel covering it */
+
+static bool _build_map(SESSION *S)
+{
+    int lines = S->SP->lines;
+    int cols = S->SP->cols;
+    int y, x;
+    PANEL *pan;
+
+    if (!S->panel_map || S->panel_map_lines != lines ||
+        S->panel_map_cols != cols)
+    {
+        if (S->panel_map)
+            PDC_sfree(S, S->panel_map);
+
+        S->panel_map = PDC_smalloc(S, lines * cols * sizeof(PANEL *));
+        if (!S->panel_map)
+            return FALSE;
+
+        S->panel_map_lines = lines;
+        S->panel_map_cols = cols;
+    }
+
+    memset(S->panel_map, 0, lines * cols * sizeof(PANEL *));
+
+    for (pan = S->panel_bottom; pan; pan = pan->above)
+    {
+        int endy = min(pan->wendy, lines);
+        int endx = min(pan->wendx, cols);
+
+        for (y = max(pan->wstarty, 0); y < endy; y++)
+            for (x = max(pan->wstartx, 0); x < endx; x++)
+                S->panel_map[y * cols + x] = pan;
+    }
+
+    S->panel_map_stale = FALSE;
+    S->stats.panel_maps++;
+
+    return TRUE;
+}
+
 /* check to see if panel is in the stack */
 
 static bool _panel_is_linked(SESSION *S, const PANEL *pan)
@@ -340,6 +510,8 @@ static void _panel_link_top(SESSION *S, PANEL *pan)
     if (!S->panel_bottom)
         S->panel_bottom = pan;
 
+    pan->geom_gen++;
+
     _calculate_obscure(S);
     dStack("<lt%d>", 9, pan);
 }
@@ -371,6 +543,8 @@ static void _panel_link_bottom(SESSION *S, PANEL *pan)
     if (!S->panel_top)
         S->panel_top = pan;
 
+    pan->geom_gen++;
+
     _calculate_obscure(S);
     dStack("<lb%d>", 9, pan);
 }
@@ -389,7 +563,7 @@ static void _panel_unlink(SESSION *S, PANEL *pan)
         return;
 #endif
     _override(S, pan, 0);
-    _free_obscure(pan);
+    _free_obscure(S, pan);
 
     prev = pan->below;
     next = pan->above;
@@ -415,6 +589,7 @@ static void _panel_unlink(SESSION *S, PANEL *pan)
 
     pan->above = (PANEL *)0;
     pan->below = (PANEL *)0;
+    pan->geom_gen++;
     dStack("<u%d>", 9, pan);
 
 }
@@ -446,7 +621,8 @@ int del_panel(SESSION *S, PANEL *pan)
         if (_panel_is_linked(S, pan))
             hide_panel(S, pan);
 
-        PDC_free((char *)pan);
+        _free_layer(S, pan);
+        PDC_sfree(S, (char *)pan);
         return OK;
     }
 
@@ -490,6 +666,7 @@ int move_panel(SESSION *S, PANEL *pan, int starty, int startx)
     getmaxyx(win, maxy, maxx);
     pan->wendy = pan->wstarty + maxy;
     pan->wendx = pan->wstartx + maxx;
+    pan->geom_gen++;
 
     if (_panel_is_linked(S, pan))
         _calculate_obscure(S);
@@ -501,10 +678,10 @@ PANEL *new_panel(SESSION *S, WINDOW *win)
 {
     PANEL *pan;
 
-    if (!S)
+    if (!S || PDC_mem_full(S))
         return (PANEL *)NULL;
 
-    pan = PDC_malloc(sizeof(PANEL));
+    pan = PDC_smalloc(S, sizeof(PANEL));
 
     if (!S->panel_stdscr_pseudo.win)
     {
@@ -534,6 +711,11 @@ PANEL *new_panel(SESSION *S, WINDOW *win)
         pan->user = (char *)0;
 #endif
         pan->obscure = (PANELOBS *)0;
+        pan->is_static = FALSE;
+        pan->content_gen = pan->geom_gen = 0;
+        pan->layer_content = pan->layer_geom = 0;
+        pan->layer = (chtype *)0;
+        pan->layer_lines = pan->layer_cols = 0;
         show_panel(S, pan);
     }
 
@@ -547,6 +729,33 @@ PANEL *panel_above(SESSION *S, const PANEL *pan)
     return pan ? pan->above : S->panel_bottom;
 }
 
+PANEL *panel_at(SESSION *S, int *y, int *x)
+{
+    PANEL *pan;
+
+    PDC_LOG(("panel_at() - called\n"));
+
+    if (!S || !S->SP || !y || !x)
+        return (PANEL *)NULL;
+
+    if (*y < 0 || *y >= S->SP->lines || *x < 0 || *x >= S->SP->cols)
+        return (PANEL *)NULL;
+
+    if ((S->panel_map_stale || S->panel_map_lines != S->SP->lines ||
+         S->panel_map_cols != S->SP->cols) && !_build_map(S))
+        return (PANEL *)NULL;
+
+    pan = S->panel_map[*y * S->panel_map_cols + *x];
+
+    if (pan)
+    {
+        *y -= pan->wstarty;
+        *x -= pan->wstartx;
+    }
+
+    return pan;
+}
+
 PANEL *panel_below(SESSION *S, const PANEL *pan)
 {
     if (!S)
@@ -561,6 +770,11 @@ int panel_hidden(SESSION *S, const PANEL *pan)
     return _panel_is_linked(S, pan) ? ERR : OK;
 }
 
+bool panel_static(const PANEL *pan)
+{
+    return pan ? pan->is_static : FALSE;
+}
+
 const void *panel_userptr(const PANEL *pan)
 {
     return pan ? pan->user : NULL;
@@ -589,6 +803,7 @@ int replace_panel(SESSION *S, PANEL *pan, WINDOW *win)
     getmaxyx(win, maxy, maxx);
     pan->wendy = pan->wstarty + maxy;
     pan->wendx = pan->wstartx + maxx;
+    pan->geom_gen++;
 
     if (_panel_is_linked(S, pan))
         _calculate_obscure(S);
@@ -596,6 +811,22 @@ int replace_panel(SESSION *S, PANEL *pan, WINDOW *win)
     return OK;
 }
 
+int set_panel_static(SESSION *S, PANEL *pan, bool flag)
+{
+    if (!S || !pan)
+        return ERR;
+
+    if (!flag)
+        _free_layer(S, pan);
+    else if (!pan->is_static)
+        Touchpan(S, pan);   /* take the layer at the next update */
+
+    pan->is_static = flag;
+    pan->content_gen++;
+
+    return OK;
+}
+
 int set_panel_userptr(PANEL *pan, const void *uptr)
 {
     if (!pan)
@@ -625,6 +856,15 @@ int top_panel(SESSION *S, PANEL *pan)
     return show_panel(S, pan);
 }
 
+void PDC_panel_free(SESSION *S)
+{
+    if (S->panel_map)
+        PDC_sfree(S, S->panel_map);
+
+    S->panel_map = (PANEL **)0;
+    S->panel_map_lines = S->panel_map_cols = 0;
+}
+
 void update_panels(SESSION *S)
 {
     PANEL *pan;
@@ -634,6 +874,16 @@ void update_panels(SESSION *S)
     if (!S)
         return;
 
+    /* a static panel whose window has been drawn on since its layer
+       was taken is recomposed in full, and its layer taken again */
+
+    for (pan = S->panel_bottom; pan; pan = pan->above)
+        if (pan->is_static && is_wintouched(S, pan->win))
+        {
+            pan->content_gen++;
+            Touchpan(S, pan);
+        }
+
     pan = S->panel_bottom;
 
     while (pan)
@@ -645,13 +895,27 @@ void update_panels(SESSION *S)
     if (is_wintouched(S, S->stdscr))
         Wnoutrefresh(S, &S->panel_stdscr_pseudo);
 
+    PDC_TRACE(S, PDC_TR_UPDATE_PANELS, NULL, 0, 0, 0);
+
     pan = S->panel_bottom;
 
     while (pan)
     {
-        if (is_wintouched(S, pan->win) || !pan->above)
+        if (_panel_cached(pan))
+        {
+            _restore_layer(S, pan);
+
+            if (!pan->above)
+                Wnoutrefresh(S, pan);   /* only places the cursor */
+        }
+        else if (is_wintouched(S, pan->win) || !pan->above)
+        {
             Wnoutrefresh(S, pan);
 
+            if (pan->is_static)
+                _save_layer(S, pan);
+        }
+
         pan = pan->above;
     }
 }
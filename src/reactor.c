@@ -0,0 +1,507 @@
+/* Public Domain Curses */
+
+#include "curspriv.h"
+
+RCSID("$Id: reactor.c,v 1.1 $")
+
+/*man-start**************************************************************
+
+  Name:                                                         reactor
+
+  Synopsis:
+        REACTOR *reactor_new(void);
+        void reactor_free(REACTOR *r);
+        int reactor_add(REACTOR *r, SESSION *S, WINDOW *win,
+                        const REACTOR_OPS *ops, void *arg);
+        int reactor_remove(REACTOR *r, SESSION *S);
+        int reactor_post(REACTOR *r, SESSION *S);
+        int reactor_timer(REACTOR *r, SESSION *S, int ms);
+        int reactor_run(REACTOR *r, int ms);
+
+  Description:
+        A reactor runs many sessions on one thread. It waits with epoll
+        on the input descriptor of each session, and on its output
+        descriptor while output is backed up, and calls the
+        application through the callbacks in REACTOR_OPS:
+
+        key(S, key, arg) gets each key read by wgetch_r() from win.
+        resize(S, arg) is called for KEY_RESIZE, after
+        resize_term(S, 0, 0). timer(S, arg) is called when the timer
+        set by reactor_timer() expires; the timers of add_timer() are
+        run as well, when due, and wgetch_r() is called again when its
+        timeout or escape delay is up. closed(S, arg) is called when
+        the input descriptor hangs up or fails, after any input still
+        waiting has been passed to key(); the session has then
+        been removed from the reactor, and the callback may delete it.
+        Any callback may be NULL.
+
+        Each callback also asks for a frame, as does reactor_post().
+        At the end of each pass, the reactor runs update_panels() and
+        doupdate() for every session that wants a frame, and writes the
+        output. When the descriptor can't take it all, further frames
+        for that session wait until it is writable again, and are then
+        drawn as one.
+
+        reactor_add() adds S to r, reading input from win. ops is
+        copied. reactor_remove() takes S out; it may be called from a
+        callback. reactor_timer() sets the one-shot timer of S to go
+        off in ms milliseconds, or clears it if ms is negative.
+
+        reactor_run() does one pass: it waits up to ms milliseconds (-1
+        for no limit), or less if a timer is due, handles what is
+        ready, and draws the frames wanted. Applications call it in a
+        loop.
+
+        The reactor needs no network access; it works with any
+        descriptors, such as the two ends of a socketpair().
+
+  Return Value:
+        reactor_new() returns NULL on failure. reactor_run() returns
+        the number of descriptors that were ready, or ERR. The other
+        functions return OK or ERR.
+
+  Portability                                X/Open    BSD    SYS V
+        reactor_new                             -       -       -
+        reactor_free                            -       -       -
+        reactor_add                             -       -       -
+        reactor_remove                          -       -       -
+        reactor_post                            -       -       -
+        reactor_timer                           -       -       -
+        reactor_run                             -       -       -
+
+**man-end****************************************************************/
+
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#define REACTOR_EVENTS 64   /* epoll events taken per pass */
+
+struct _reactor_fd
+{
+    struct _reactor_ent *e;
+    int fd;                     /* -1 if not registered */
+    unsigned events;            /* registered epoll events */
+};
+
+struct _reactor_ent
+{
+    REACTOR *r;
+    SESSION *S;
+    WINDOW *win;
+    REACTOR_OPS ops;
+    void *arg;
+    struct _reactor_fd in;
+    struct _reactor_fd out;     /* unused when it's the input fd */
+    bool frame;                 /* a frame is wanted */
+    bool blocked;               /* output waits for the fd */
+    bool dead;                  /* removed; freed after the pass */
+    bool timer_set;
+    bool wait_set;              /* wgetch_r() has a timeout running */
+    bool input_due;             /* wgetch_r() to be called again */
+    unsigned long timer_at;     /* PDC_get_clock() when it goes off */
+    unsigned long wait_at;      /* and when wgetch_r()'s timeout ends */
+    struct _reactor_ent *prev, *next;
+};
+
+struct _reactor
+{
+    int epfd;
+    struct _reactor_ent *all;
+    struct _reactor_ent *dead;  /* removed during this pass */
+};
+
+static int _watch(REACTOR *r, struct _reactor_fd *f, unsigned events)
+{
+    struct epoll_event ev;
+
+    if (events == f->events)
+        return OK;
+
+    ev.events = events;
+    ev.data.ptr = f;
+
+    if (epoll_ctl(r->epfd, f->events ? EPOLL_CTL_MOD : EPOLL_CTL_ADD,
+                  f->fd, &ev) == -1)
+        return ERR;
+
+    f->events = events;
+
+    return OK;
+}
+
+/* watch or stop watching for output room, on whichever fd it uses */
+
+static void _want_output(struct _reactor_ent *e, bool flag)
+{
+    struct _reactor_fd *f = (e->out.fd >= 0) ? &e->out : &e->in;
+    unsigned events = flag ? (f->events | EPOLLOUT) :
+                             (f->events & ~EPOLLOUT);
+
+    if (!events)
+    {
+        epoll_ctl(e->r->epfd, EPOLL_CTL_DEL, f->fd, NULL);
+        f->events = 0;
+    }
+    else
+        _watch(e->r, f, events);
+
+    e->blocked = flag;
+}
+
+static void _flush(struct _reactor_ent *e)
+{
+    int rc = PDC_flush(e->S);
+
+    if (rc == PDC_WOULDBLOCK)
+    {
+        if (!e->blocked)
+            _want_output(e, TRUE);
+    }
+    else if (e->blocked)
+        _want_output(e, FALSE);
+}
+
+static void _draw(struct _reactor_ent *e)
+{
+    e->frame = FALSE;
+
+    update_panels(e->S);
+    doupdate(e->S);
+
+    _flush(e);
+}
+
+static void _input(struct _reactor_ent *e)
+{
+    int key, ms;
+
+    while (!e->dead)
+    {
+        key = wgetch_r(e->S, e->win, &ms);
+
+        /* a lone ESC, halfdelay() or timeout() must be called back for
+           when the time it reports is up, input or not */
+
+        if (key == PDC_WOULDBLOCK)
+        {
+            e->wait_set = (ms >= 0);
+
+            if (e->wait_set)
+                e->wait_at = PDC_get_clock(e->S) + ms;
+
+            break;
+        }
+
+        e->wait_set = FALSE;
+
+        if (key == ERR)
+            break;
+
+        if (key == KEY_RESIZE)
+        {
+            resize_term(e->S, 0, 0);
+
+            if (e->ops.resize)
+                (*e->ops.resize)(e->S, e->arg);
+        }
+        else if (e->ops.key)
+            (*e->ops.key)(e->S, key, e->arg);
+
+        e->frame = TRUE;
+    }
+}
+
+REACTOR *reactor_new(void)
+{
+    REACTOR *r;
+
+    PDC_LOG(("reactor_new() - called\n"));
+
+    if (!(r = PDC_calloc(1, sizeof(REACTOR))))
+        return (REACTOR *)NULL;
+
+    if ((r->epfd = epoll_create1(EPOLL_CLOEXEC)) == -1)
+    {
+        PDC_free(r);
+        return (REACTOR *)NULL;
+    }
+
+    return r;
+}
+
+static void _free_dead(REACTOR *r)
+{
+    struct _reactor_ent *e;
+
+    while ((e = r->dead) != NULL)
+    {
+        r->dead = e->next;
+        PDC_free(e);
+    }
+}
+
+void reactor_free(REACTOR *r)
+{
+    PDC_LOG(("reactor_free() - called\n"));
+
+    if (!r)
+        return;
+
+    while (r->all)
+        reactor_remove(r, r->all->S);
+
+    _free_dead(r);
+
+    close(r->epfd);
+    PDC_free(r);
+}
+
+int reactor_add(REACTOR *r, SESSION *S, WINDOW *win, const REACTOR_OPS *ops,
+                void *arg)
+{
+    struct _reactor_ent *e;
+    int out;
+
+    PDC_LOG(("reactor_add() - called\n"));
+
+    if (!r || !S || !win || S->reactor)
+        return ERR;
+
+    if (!(e = PDC_calloc(1, sizeof(struct _reactor_ent))))
+        return ERR;
+
+    e->r = r;
+    e->S = S;
+    e->win = win;
+    e->arg = arg;
+
+    if (ops)
+        e->ops = *ops;
+
+    e->in.e = e->out.e = e;
+    e->in.fd = (int)PDC_get_input_fd(S);
+    e->out.fd = -1;
+
+    out = PDC_get_output_fd(S);
+
+    if (out >= 0 && out != e->in.fd)
+        e->out.fd = out;
+
+    if (_watch(r, &e->in, EPOLLIN|EPOLLRDHUP) == ERR)
+    {
+        PDC_free(e);
+        return ERR;
+    }
+
+    e->next = r->all;
+    if (r->all)
+        r->all->prev = e;
+    r->all = e;
+
+    S->reactor = e;
+
+    e->frame = TRUE;    /* draw the first screen */
+
+    return OK;
+}
+
+int reactor_remove(REACTOR *r, SESSION *S)
+{
+    struct _reactor_ent *e;
+
+    PDC_LOG(("reactor_remove() - called\n"));
+
+    if (!r || !S || !(e = S->reactor) || e->r != r)
+        return ERR;
+
+    if (e->in.events)
+        epoll_ctl(r->epfd, EPOLL_CTL_DEL, e->in.fd, NULL);
+
+    if (e->out.events)
+        epoll_ctl(r->epfd, EPOLL_CTL_DEL, e->out.fd, NULL);
+
+    if (e->prev)
+        e->prev->next = e->next;
+    else
+        r->all = e->next;
+
+    if (e->next)
+        e->next->prev = e->prev;
+
+    /* events for it may still be pending in this pass */
+
+    e->dead = TRUE;
+    e->next = r->dead;
+    r->dead = e;
+
+    S->reactor = NULL;
+
+    return OK;
+}
+
+int reactor_post(REACTOR *r, SESSION *S)
+{
+    PDC_LOG(("reactor_post() - called\n"));
+
+    if (!r || !S || !S->reactor || S->reactor->r != r)
+        return ERR;
+
+    S->reactor->frame = TRUE;
+
+    return OK;
+}
+
+int reactor_timer(REACTOR *r, SESSION *S, int ms)
+{
+    struct _reactor_ent *e;
+
+    PDC_LOG(("reactor_timer() - called: ms %d\n", ms));
+
+    if (!r || !S || !(e = S->reactor) || e->r != r)
+        return ERR;
+
+    e->timer_set = (ms >= 0);
+
+    if (e->timer_set)
+        e->timer_at = PDC_get_clock(S) + ms;
+
+    return OK;
+}
+
+/* ms, or less if at comes sooner */
+
+static int _sooner(struct _reactor_ent *e, unsigned long at, int ms)
+{
+    long left = (long)(at - PDC_get_clock(e->S));
+
+    if (left < 0)
+        left = 0;
+
+    return (ms < 0 || left < ms) ? (int)left : ms;
+}
+
+int reactor_run(REACTOR *r, int ms)
+{
+    struct epoll_event ev[REACTOR_EVENTS];
+    struct _reactor_ent *e;
+    int n, i;
+
+    PDC_LOG(("reactor_run() - called: ms %d\n", ms));
+
+    if (!r)
+        return ERR;
+
+    /* don't sleep past the next timer or input timeout, nor at all if
+       a frame is due */
+
+    for (e = r->all; e; e = e->next)
+    {
+        if (e->frame && !e->blocked)
+            ms = 0;
+        else
+        {
+            if (e->timer_set)
+                ms = _sooner(e, e->timer_at, ms);
+
+            if (e->wait_set)
+                ms = _sooner(e, e->wait_at, ms);
+
+            ms = PDC_timer_wait(e->S, ms);
+        }
+    }
+
+    n = epoll_wait(r->epfd, ev, REACTOR_EVENTS, ms);
+
+    if (n == -1)
+        n = 0;      /* EINTR; the pass goes on with timers and frames */
+
+    for (i = 0; i < n; i++)
+    {
+        struct _reactor_fd *f = ev[i].data.ptr;
+
+        e = f->e;
+
+        if (e->dead)
+            continue;
+
+        /* room for output; an error on the output fd also ends
+           the wait, as the flush then fails */
+
+        if ((ev[i].events & EPOLLOUT) || f == &e->out)
+        {
+            _flush(e);
+
+            if (e->dead)
+                continue;
+        }
+
+        if (f == &e->in && (ev[i].events & ~EPOLLOUT))
+        {
+            _input(e);
+
+            if (!e->dead &&
+                (ev[i].events & (EPOLLRDHUP|EPOLLHUP|EPOLLERR)))
+            {
+                reactor_remove(r, e->S);
+
+                if (e->ops.closed)
+                    (*e->ops.closed)(e->S, e->arg);
+            }
+        }
+    }
+
+    /* the session timers run within wgetch_r(), and their frame is
+       drawn below; it also ends a timeout() or the wait after a lone
+       ESC that is up. As the key callbacks may remove any session,
+       the due ones are marked first */
+
+    for (e = r->all; e; e = e->next)
+        e->input_due = !PDC_timer_wait(e->S, -1) ||
+            (e->wait_set && (long)(e->wait_at - PDC_get_clock(e->S)) <= 0);
+
+    for (e = r->all; e; )
+    {
+        if (e->input_due)
+        {
+            e->input_due = FALSE;
+            e->frame = TRUE;
+
+            _input(e);
+
+            e = r->all;
+            continue;
+        }
+
+        e = e->next;
+    }
+
+    /* a timer callback may remove any session, so start over after
+       each; the ones that went off are cleared first */
+
+    for (e = r->all; e; )
+    {
+        if (e->timer_set &&
+            (long)(e->timer_at - PDC_get_clock(e->S)) <= 0)
+        {
+            e->timer_set = FALSE;
+            e->frame = TRUE;
+
+            if (e->ops.timer)
+            {
+                (*e->ops.timer)(e->S, e->arg);
+                e = r->all;
+                continue;
+            }
+        }
+
+        e = e->next;
+    }
+
+    for (e = r->all; e; e = e->next)
+        if (e->frame && !e->blocked)
+            _draw(e);
+
+    _free_dead(r);
+
+    return n;
+}
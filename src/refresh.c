@@ -25,6 +25,10 @@ RCSID("$Id: refresh.c,v 1.56 2008/07/13 16:08:18 wmcbrine Exp $")
         leaveok() has been enabled, the physical cursor of the terminal
         is left at the location of the window's cursor.
 
+        doupdate() gives way to input when typeahead() is on: if a key
+        is waiting, it returns before the screen is complete, and the
+        lines not yet sent are left for the next doupdate().
+
         wnoutrefresh() and doupdate() allow multiple updates with more
         efficiency than wrefresh() alone. wrefresh() works by first
         calling wnoutrefresh(), which copies the named window to the
@@ -61,15 +65,25 @@ int wnoutrefresh(SESSION *S, WINDOW *win)
 {
     int begy, begx;     /* window's place on screen   */
     int i, j;
+    unsigned long copied;
 
     PDC_LOG(("wnoutrefresh() - called: win=%p\n", win));
 
     if (!S || !win || (win->_flags & (_PAD|_SUBPAD)))
         return ERR;
 
+    /* the rows must be compared with what was really drawn, not with a
+       flash over it; it ends here */
+
+    if (S->flash_state == PDC_FLASH_CELLS)
+        PDC_flash_end(S);
+
     begy = win->_begy;
     begx = win->_begx;
 
+    S->stats.refreshes++;
+    copied = S->stats.cells_copied;
+
     for (i = 0, j = begy; i < win->_maxy; i++, j++)
     {
         if (win->_firstch[i] != _NO_CHANGE)
@@ -89,6 +103,9 @@ int wnoutrefresh(SESSION *S, WINDOW *win)
             while (last >= first && src[last] == dest[last])
                 last--;
 
+            S->stats.cells_compared += win->_lastch[i] -
+                                       win->_firstch[i] + 1;
+
             /* if any have really changed... */
 
             if (first <= last)
@@ -96,6 +113,8 @@ int wnoutrefresh(SESSION *S, WINDOW *win)
                 memcpy(dest + first, src + first,
                        (last - first + 1) * sizeof(chtype));
 
+                S->stats.cells_copied += last - first + 1;
+
                 first += begx;
                 last += begx;
 
@@ -122,19 +141,29 @@ int wnoutrefresh(SESSION *S, WINDOW *win)
         S->curscr->_curx = win->_curx + begx;
     }
 
+    PDC_TRACE(S, PDC_TR_WNOUTREFRESH, win, begy, begx,
+              S->stats.cells_copied - copied);
+
     return OK;
 }
 
 int doupdate(SESSION *S)
 {
-    int y;
+    int y, done = 0;
     bool clearall;
+    unsigned long start, rows;
 
     PDC_LOG(("doupdate() - called\n"));
 
     if (!S || !S->curscr)
         return ERR;
 
+    start = PDC_stats_usec();
+    rows = S->stats.rows_sent;
+
+    PDC_TRACE(S, PDC_TR_DOUPDATE, S->curscr, S->curscr->_cury,
+              S->curscr->_curx, 0);
+
     if (isendwin(S))         /* coming back after endwin() called */
     {
         reset_prog_mode(S);
@@ -144,7 +173,34 @@ int doupdate(SESSION *S)
     else
         clearall = S->curscr->_clear;
 
-    for (y = 0; y < S->SP->lines; y++)
+    if (S->flash_state &&
+        (long)(PDC_get_clock(S) - S->flash_until) >= 0)
+        PDC_flash_end(S);
+
+    /* pnoutrefresh() has already shifted these rows of curscr; move the
+       physical screen to match, or repaint them if it can't be done */
+
+    if (S->scroll_hint_n)
+    {
+        if (!clearall && PDC_scroll(S, S->scroll_hint_top,
+            S->scroll_hint_bot, S->scroll_hint_n) == ERR)
+            for (y = S->scroll_hint_top; y <= S->scroll_hint_bot; y++)
+            {
+                S->curscr->_firstch[y] = 0;
+                S->curscr->_lastch[y] = S->COLS - 1;
+            }
+
+        S->scroll_hint_n = 0;
+    }
+
+    /* big updates may be shared among threads; see doupdate_threads() */
+
+    if (PDC_rowpar_update(S, clearall) == OK)
+        y = S->SP->lines;
+    else
+        y = 0;
+
+    for (; y < S->SP->lines; y++)
     {
         PDC_LOG(("doupdate() - Transforming line %d of %d: %s\n",
                  y, SP->lines, (curscr->_firstch[y] != _NO_CHANGE) ?
@@ -156,6 +212,28 @@ int doupdate(SESSION *S)
 
             chtype *src = S->curscr->_y[y];
 
+            /* with typeahead() on, stop when a key comes in, every few
+               lines; the rest stay dirty for the next doupdate() */
+
+            if (S->typeahead && !(done++ % PDC_TYPEAHEAD_ROWS) &&
+                PDC_input_pending(S))
+            {
+                if (clearall)
+                    for (; y < S->SP->lines; y++)
+                    {
+                        S->curscr->_firstch[y] = 0;
+                        S->curscr->_lastch[y] = S->COLS - 1;
+                    }
+
+                S->curscr->_clear = FALSE;
+
+                PDC_stats_update(S, start, FALSE);
+                PDC_TRACE(S, PDC_TR_DOUPDATE_END, S->curscr, y, 0,
+                          S->stats.rows_sent - rows);
+
+                return OK;
+            }
+
             if (clearall)
             {
                 first = 0;
@@ -172,6 +250,9 @@ int doupdate(SESSION *S)
             if (len)
             {
                 PDC_transform_line(S, y, first, len, src+first);
+
+                S->stats.rows_sent++;
+                S->stats.cells_sent += len;
             }
 
             S->curscr->_firstch[y] = _NO_CHANGE;
@@ -187,6 +268,10 @@ int doupdate(SESSION *S)
     S->SP->cursrow = S->curscr->_cury;
     S->SP->curscol = S->curscr->_curx;
 
+    PDC_stats_update(S, start, TRUE);
+    PDC_TRACE(S, PDC_TR_DOUPDATE_END, S->curscr, S->curscr->_cury,
+              S->curscr->_curx, S->stats.rows_sent - rows);
+
     return OK;
 }
 
@@ -0,0 +1,317 @@
+/* Public Domain Curses */
+
+#include "curspriv.h"
+
+RCSID("$Id: rowpar.c,v 1.1 $")
+
+/*man-start**************************************************************
+
+  Name:                                                         rowpar
+
+  Synopsis:
+        int doupdate_threads(SESSION *S, int nthreads);
+
+  Description:
+        doupdate_threads() lets doupdate() share a large update among
+        nthreads threads. The changed rows are split into nthreads
+        runs of about the same number of cells; each thread encodes
+        its run into a segment of output for the terminal, and the
+        segments are then written out in row order. Updates of fewer
+        than PDC_ROWPAR_MIN cells, which are most of them, are still
+        done on the calling thread alone.
+
+        The threads belong to the session and sleep between updates.
+        A value of 0 or 1 stops them and restores the serial update;
+        delscreen() does the same.
+
+        The platform must be able to encode rows into separate
+        segments (see PDC_seg_open()); otherwise the call fails, and
+        doupdate() stays serial.
+
+  Return Value:
+        doupdate_threads() returns OK or ERR.
+
+  Portability                                X/Open    BSD    SYS V
+        doupdate_threads                        -       -       -
+
+**man-end****************************************************************/
+
+#include <pthread.h>
+
+#define PDC_ROWPAR_MIN 8192   /* cells changed before threads are used */
+
+struct _rowpar
+{
+    pthread_mutex_t lock;
+    pthread_cond_t start;       /* gen went up, or stop was set */
+    pthread_cond_t done;        /* remaining reached zero */
+    unsigned long gen;          /* number of the current update */
+    int remaining;              /* workers still encoding */
+    bool stop;
+    bool clearall;
+    int nseg;
+    int nthreads;               /* workers started; nseg - 1 if all ok */
+    pthread_t *thread;
+    void **seg;                 /* platform output segments */
+    int *bound;                 /* segment i covers rows bound[i] to
+                                   bound[i + 1] - 1 */
+    SESSION *S;
+};
+
+struct _rowpar_arg
+{
+    struct _rowpar *rp;
+    int i;
+};
+
+/* Encode the changed parts of rows bound[i] .. bound[i + 1] - 1 into
+   segment i. Each run is disjoint, so no locking is needed here. */
+
+static void _encode(struct _rowpar *rp, int i)
+{
+    SESSION *S = rp->S;
+    WINDOW *curscr = S->curscr;
+    int y;
+
+    for (y = rp->bound[i]; y < rp->bound[i + 1]; y++)
+    {
+        int first, last;
+
+        if (rp->clearall)
+        {
+            first = 0;
+            last = S->COLS - 1;
+        }
+        else if (curscr->_firstch[y] == _NO_CHANGE)
+            continue;
+        else
+        {
+            first = curscr->_firstch[y];
+            last = curscr->_lastch[y];
+        }
+
+        if (last >= first)
+            PDC_seg_line(S, rp->seg[i], y, first, last - first + 1,
+                         curscr->_y[y] + first);
+
+        curscr->_firstch[y] = _NO_CHANGE;
+        curscr->_lastch[y] = _NO_CHANGE;
+    }
+}
+
+static void *_rowpar_worker(void *arg)
+{
+    struct _rowpar *rp = ((struct _rowpar_arg *)arg)->rp;
+    int i = ((struct _rowpar_arg *)arg)->i;
+    unsigned long seen = 0;
+    bool stop;
+
+    PDC_free(arg);
+
+    for (;;)
+    {
+        pthread_mutex_lock(&rp->lock);
+
+        while (rp->gen == seen && !rp->stop)
+            pthread_cond_wait(&rp->start, &rp->lock);
+
+        seen = rp->gen;
+        stop = rp->stop;
+
+        pthread_mutex_unlock(&rp->lock);
+
+        if (stop)
+            return NULL;
+
+        _encode(rp, i);
+
+        pthread_mutex_lock(&rp->lock);
+
+        if (!--rp->remaining)
+            pthread_cond_signal(&rp->done);
+
+        pthread_mutex_unlock(&rp->lock);
+    }
+}
+
+void PDC_rowpar_free(SESSION *S)
+{
+    struct _rowpar *rp;
+    int i;
+
+    if (!S || !(rp = S->rowpar))
+        return;
+
+    pthread_mutex_lock(&rp->lock);
+    rp->stop = TRUE;
+    pthread_cond_broadcast(&rp->start);
+    pthread_mutex_unlock(&rp->lock);
+
+    for (i = 0; i < rp->nthreads; i++)
+        pthread_join(rp->thread[i], NULL);
+
+    for (i = 0; i < rp->nseg; i++)
+        if (rp->seg[i])
+            PDC_seg_close(S, rp->seg[i]);
+
+    pthread_mutex_destroy(&rp->lock);
+    pthread_cond_destroy(&rp->start);
+    pthread_cond_destroy(&rp->done);
+
+    PDC_sfree(S, rp);
+    S->rowpar = NULL;
+}
+
+int doupdate_threads(SESSION *S, int nthreads)
+{
+    struct _rowpar *rp;
+    int i;
+
+    PDC_LOG(("doupdate_threads() - called: nthreads %d\n", nthreads));
+
+    if (!S || nthreads < 0)
+        return ERR;
+
+    PDC_rowpar_free(S);
+
+    if (nthreads <= 1)
+        return OK;
+
+    /* one block: the struct, then thread ids, segments and bounds */
+
+    rp = PDC_scalloc(S, 1, sizeof(struct _rowpar) +
+                    nthreads * (sizeof(pthread_t) + sizeof(void *) +
+                    sizeof(int)) + sizeof(int));
+    if (!rp)
+        return ERR;
+
+    rp->thread = (pthread_t *)(rp + 1);
+    rp->seg = (void **)(rp->thread + nthreads);
+    rp->bound = (int *)(rp->seg + nthreads);
+    rp->nseg = nthreads;
+    rp->S = S;
+
+    pthread_mutex_init(&rp->lock, NULL);
+    pthread_cond_init(&rp->start, NULL);
+    pthread_cond_init(&rp->done, NULL);
+
+    S->rowpar = rp;
+
+    for (i = 0; i < nthreads; i++)
+        if (!(rp->seg[i] = PDC_seg_open(S)))
+        {
+            PDC_rowpar_free(S);
+            return ERR;
+        }
+
+    /* segment 0 is encoded by the thread calling doupdate() */
+
+    for (i = 1; i < nthreads; i++)
+    {
+        struct _rowpar_arg *arg = PDC_malloc(sizeof(struct _rowpar_arg));
+
+        if (!arg)
+            break;
+
+        arg->rp = rp;
+        arg->i = i;
+
+        if (pthread_create(rp->thread + rp->nthreads, NULL,
+                           _rowpar_worker, arg))
+        {
+            PDC_free(arg);
+            break;
+        }
+
+        rp->nthreads++;
+    }
+
+    if (rp->nthreads < nthreads - 1)
+    {
+        PDC_rowpar_free(S);
+        return ERR;
+    }
+
+    return OK;
+}
+
+/* Called by doupdate() with the same clearall it would use itself.
+   Returns ERR, having done nothing, when the update is too small to be
+   worth splitting; doupdate() then does it serially. */
+
+int PDC_rowpar_update(SESSION *S, bool clearall)
+{
+    struct _rowpar *rp;
+    WINDOW *curscr;
+    long total, target, acc;
+    int lines, rows, y, i;
+
+    if (!S || !(rp = S->rowpar))
+        return ERR;
+
+    curscr = S->curscr;
+    lines = S->SP->lines;
+
+    if (clearall)
+    {
+        total = (long)lines * S->COLS;
+        rows = lines;
+    }
+    else
+        for (total = 0, rows = 0, y = 0; y < lines; y++)
+            if (curscr->_firstch[y] != _NO_CHANGE)
+            {
+                total += curscr->_lastch[y] - curscr->_firstch[y] + 1;
+                rows++;
+            }
+
+    if (total < PDC_ROWPAR_MIN)
+        return ERR;
+
+    /* split the rows into runs of about total / nseg changed cells */
+
+    target = (total + rp->nseg - 1) / rp->nseg;
+
+    rp->bound[0] = 0;
+
+    for (i = 1, acc = 0, y = 0; y < lines && i < rp->nseg; y++)
+    {
+        if (clearall)
+            acc += S->COLS;
+        else if (curscr->_firstch[y] != _NO_CHANGE)
+            acc += curscr->_lastch[y] - curscr->_firstch[y] + 1;
+
+        if (acc >= target * i)
+            rp->bound[i++] = y + 1;
+    }
+
+    while (i <= rp->nseg)
+        rp->bound[i++] = lines;
+
+    rp->clearall = clearall;
+
+    pthread_mutex_lock(&rp->lock);
+    rp->remaining = rp->nthreads;
+    rp->gen++;
+    pthread_cond_broadcast(&rp->start);
+    pthread_mutex_unlock(&rp->lock);
+
+    _encode(rp, 0);
+
+    pthread_mutex_lock(&rp->lock);
+
+    while (rp->remaining)
+        pthread_cond_wait(&rp->done, &rp->lock);
+
+    pthread_mutex_unlock(&rp->lock);
+
+    /* stitch: the segments go out in row order */
+
+    for (i = 0; i < rp->nseg; i++)
+        PDC_seg_flush(S, rp->seg[i]);
+
+    S->stats.rows_sent += rows;
+    S->stats.cells_sent += total;
+
+    return OK;
+}
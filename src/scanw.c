@@ -15,15 +15,25 @@ RCSID("$Id: scanw.c,v 1.42 2008/07/14 12:22:13 wmcbrine Exp $")
         int mvwscanw(WINDOW *win, int y, int x, const char *fmt, ...);
         int vwscanw(WINDOW *win, const char *fmt, va_list varglist);
         int vw_scanw(WINDOW *win, const char *fmt, va_list varglist);
+        int wscanw_r(WINDOW *win, int *ms, const char *fmt, ...);
+        int vw_scanw_r(WINDOW *win, int *ms, const char *fmt,
+                       va_list varglist);
 
   Description:
         These routines correspond to the standard C library's scanf()
         family. Each gets a string from the window via wgetnstr(), and
         uses the resulting line as input for the scan.
 
+        wscanw_r() and vw_scanw_r() read the line with wgetnstr_r()
+        instead, into a buffer kept in the session. Until the line is
+        complete they return PDC_WOULDBLOCK, and should be called again
+        with the same arguments once input may be ready; see
+        wgetch_r().
+
   Return Value:
         On successful completion, these functions return the number of
-        items successfully matched.  Otherwise they return ERR.
+        items successfully matched.  Otherwise they return ERR, or for
+        wscanw_r() and vw_scanw_r(), possibly PDC_WOULDBLOCK.
 
   Portability                                X/Open    BSD    SYS V
         scanw                                   Y       Y       Y
@@ -32,6 +42,8 @@ RCSID("$Id: scanw.c,v 1.42 2008/07/14 12:22:13 wmcbrine Exp $")
         mvwscanw                                Y       Y       Y
         vwscanw                                 Y       -      4.0
         vw_scanw                                Y
+        wscanw_r                                -       -       -
+        vw_scanw_r                              -       -       -
 
 **man-end****************************************************************/
 
@@ -128,6 +140,38 @@ int vw_scanw(SESSION *S, WINDOW *win, const char *fmt, va_list varglist)
     return vwscanw(S, win, fmt, varglist);
 }
 
+int vw_scanw_r(SESSION *S, WINDOW *win, int *ms, const char *fmt,
+               va_list varglist)
+{
+    int retval;
+
+    PDC_LOG(("vw_scanw_r() - called\n"));
+
+    if (!S)
+        return ERR;
+
+    retval = wgetnstr_r(S, win, S->scanw_buf, 255, ms);
+
+    if (retval != OK)
+        return retval;
+
+    return vsscanf(S->scanw_buf, fmt, varglist);
+}
+
+int wscanw_r(SESSION *S, WINDOW *win, int *ms, const char *fmt, ...)
+{
+    va_list args;
+    int retval;
+
+    PDC_LOG(("wscanw_r() - called\n"));
+
+    va_start(args, fmt);
+    retval = vw_scanw_r(S, win, ms, fmt, args);
+    va_end(args);
+
+    return retval;
+}
+
 #ifndef HAVE_VSSCANF
 
 /* _pdc_vsscanf() - Internal routine to parse and format an input
@@ -0,0 +1,449 @@
+/* Public Domain Curses */
+
+#include "curspriv.h"
+
+RCSID("$Id: sched.c,v 1.1 $")
+
+/*man-start**************************************************************
+
+  Name:                                                         sched
+
+  Synopsis:
+        SCHED *sched_new(int nworkers);
+        void sched_free(SCHED *s);
+        int sched_add(SCHED *s, SESSION *S,
+                      void (*frame)(SESSION *, void *), void *arg);
+        int sched_remove(SCHED *s, SESSION *S);
+        int sched_post(SCHED *s, SESSION *S);
+        int sched_drain(SCHED *s);
+
+  Description:
+        A scheduler owns a set of worker threads and redraws the
+        sessions attached to it. Each time a session has a frame to
+        show, sched_post() queues it; a worker then calls the
+        session's frame callback (if any), update_panels() and
+        doupdate(). A session is never run by two workers at once;
+        posting a session that is being run makes it run once more
+        afterwards, and posting one that is already queued does
+        nothing, so bursts of posts collapse into a single frame.
+
+        Each worker has its own queue, and each session belongs to
+        the queue of the worker it was assigned to by sched_add(). A
+        worker whose queue is empty takes work from the others, so a
+        session with a heavy frame delays only the sessions queued
+        behind it on one worker.
+
+        sched_new() starts nworkers threads. sched_free() stops them,
+        waiting for any frame in progress, and detaches every session.
+
+        sched_add() attaches S to s. frame, when not NULL, is called
+        by the worker with S and arg before the update; it is the
+        place to draw, since the application must not touch S from
+        another thread between sched_post() and the end of the frame.
+        A session can be attached to only one scheduler.
+
+        sched_remove() detaches S, first waiting for a frame of S
+        that is in progress. A frame still queued is dropped.
+
+        sched_drain() waits until no frame is queued or running.
+
+  Return Value:
+        sched_new() returns NULL on failure. The other functions
+        return OK or ERR.
+
+  Portability                                X/Open    BSD    SYS V
+        sched_new                               -       -       -
+        sched_free                              -       -       -
+        sched_add                               -       -       -
+        sched_remove                            -       -       -
+        sched_post                              -       -       -
+        sched_drain                             -       -       -
+
+**man-end****************************************************************/
+
+#include <pthread.h>
+
+enum { ENT_IDLE, ENT_QUEUED, ENT_RUNNING, ENT_AGAIN, ENT_DEAD };
+
+struct _sched_ent
+{
+    SESSION *S;
+    void (*frame)(SESSION *, void *);
+    void *arg;
+    int state;                  /* ENT_*, guarded by the home lock */
+    bool removing;              /* sched_remove() waits for the frame */
+    struct _sched_worker *home;
+    struct _sched_ent *next;    /* in the home queue */
+    struct _sched_ent *prev_all, *next_all;
+};
+
+struct _sched_worker
+{
+    struct _sched *s;
+    pthread_t thread;
+    pthread_mutex_t lock;       /* queue and state of its sessions */
+    pthread_cond_t done;        /* a frame of a removed session ended */
+    struct _sched_ent *head, *tail;
+};
+
+struct _sched
+{
+    pthread_mutex_t lock;       /* counters and the list of sessions */
+    pthread_cond_t work;        /* pending went up, or stop was set */
+    pthread_cond_t idle;        /* pending and running reached zero */
+    int pending;                /* queued frames not yet claimed */
+    int running;                /* frames claimed by a worker */
+    bool stop;
+    int nworkers;
+    int next_home;
+    struct _sched_ent *all;
+    struct _sched_worker *w;
+};
+
+static void _enqueue(struct _sched_worker *w, struct _sched_ent *e)
+{
+    e->state = ENT_QUEUED;
+    e->next = NULL;
+
+    if (w->tail)
+        w->tail->next = e;
+    else
+        w->head = e;
+
+    w->tail = e;
+}
+
+static struct _sched_ent *_dequeue(struct _sched_worker *w)
+{
+    struct _sched_ent *e;
+
+    pthread_mutex_lock(&w->lock);
+
+    if ((e = w->head) != NULL)
+    {
+        if (!(w->head = e->next))
+            w->tail = NULL;
+
+        if (e->state == ENT_QUEUED)
+            e->state = ENT_RUNNING;
+    }
+
+    pthread_mutex_unlock(&w->lock);
+
+    return e;
+}
+
+static void _unlink_all(struct _sched *s, struct _sched_ent *e)
+{
+    if (e->prev_all)
+        e->prev_all->next_all = e->next_all;
+    else
+        s->all = e->next_all;
+
+    if (e->next_all)
+        e->next_all->prev_all = e->prev_all;
+}
+
+static void _wake(struct _sched *s)
+{
+    pthread_mutex_lock(&s->lock);
+    s->pending++;
+    pthread_cond_signal(&s->work);
+    pthread_mutex_unlock(&s->lock);
+}
+
+static void *_worker(void *arg)
+{
+    struct _sched_worker *self = arg;
+    struct _sched *s = self->s;
+    int me = (int)(self - s->w);
+
+    for (;;)
+    {
+        struct _sched_ent *e = NULL;
+        bool again, dead;
+        int i;
+
+        pthread_mutex_lock(&s->lock);
+
+        while (!s->pending && !s->stop)
+            pthread_cond_wait(&s->work, &s->lock);
+
+        if (s->stop)
+        {
+            pthread_mutex_unlock(&s->lock);
+            return NULL;
+        }
+
+        s->pending--;
+        s->running++;
+
+        pthread_mutex_unlock(&s->lock);
+
+        /* Having claimed a frame, look for it: own queue first, then
+           steal from the others. Claims never exceed queued entries,
+           so the scan finds one, though maybe not on the first pass. */
+
+        for (i = 0; !e; i++)
+            e = _dequeue(s->w + (me + i) % s->nworkers);
+
+        dead = (e->state == ENT_DEAD);
+
+        if (!dead)
+        {
+            if (e->frame)
+                (*e->frame)(e->S, e->arg);
+
+            update_panels(e->S);
+            doupdate(e->S);
+        }
+
+        pthread_mutex_lock(&e->home->lock);
+
+        again = (e->state == ENT_AGAIN && !e->removing);
+
+        if (again)
+            _enqueue(e->home, e);
+        else if (!dead)
+            e->state = ENT_IDLE;
+
+        if (e->removing)
+            pthread_cond_broadcast(&e->home->done);
+
+        pthread_mutex_unlock(&e->home->lock);
+
+        pthread_mutex_lock(&s->lock);
+
+        if (dead)
+        {
+            _unlink_all(s, e);
+            PDC_free(e);
+        }
+
+        if (again)
+        {
+            s->pending++;
+            pthread_cond_signal(&s->work);
+        }
+
+        if (!--s->running && !s->pending)
+            pthread_cond_broadcast(&s->idle);
+
+        pthread_mutex_unlock(&s->lock);
+    }
+}
+
+SCHED *sched_new(int nworkers)
+{
+    SCHED *s;
+    int i;
+
+    PDC_LOG(("sched_new() - called: nworkers %d\n", nworkers));
+
+    if (nworkers < 1)
+        return (SCHED *)NULL;
+
+    if (!(s = PDC_calloc(1, sizeof(SCHED))))
+        return (SCHED *)NULL;
+
+    if (!(s->w = PDC_calloc(nworkers, sizeof(struct _sched_worker))))
+    {
+        PDC_free(s);
+        return (SCHED *)NULL;
+    }
+
+    pthread_mutex_init(&s->lock, NULL);
+    pthread_cond_init(&s->work, NULL);
+    pthread_cond_init(&s->idle, NULL);
+
+    for (i = 0; i < nworkers; i++)
+    {
+        s->w[i].s = s;
+        pthread_mutex_init(&s->w[i].lock, NULL);
+        pthread_cond_init(&s->w[i].done, NULL);
+
+        if (pthread_create(&s->w[i].thread, NULL, _worker, s->w + i))
+            break;
+
+        s->nworkers++;
+    }
+
+    if (s->nworkers < nworkers)
+    {
+        sched_free(s);
+        return (SCHED *)NULL;
+    }
+
+    return s;
+}
+
+void sched_free(SCHED *s)
+{
+    struct _sched_ent *e;
+    int i;
+
+    PDC_LOG(("sched_free() - called\n"));
+
+    if (!s)
+        return;
+
+    pthread_mutex_lock(&s->lock);
+    s->stop = TRUE;
+    pthread_cond_broadcast(&s->work);
+    pthread_mutex_unlock(&s->lock);
+
+    for (i = 0; i < s->nworkers; i++)
+        pthread_join(s->w[i].thread, NULL);
+
+    while ((e = s->all) != NULL)
+    {
+        if (e->S)
+            e->S->sched = NULL;
+
+        s->all = e->next_all;
+        PDC_free(e);
+    }
+
+    for (i = 0; i < s->nworkers; i++)
+    {
+        pthread_mutex_destroy(&s->w[i].lock);
+        pthread_cond_destroy(&s->w[i].done);
+    }
+
+    pthread_mutex_destroy(&s->lock);
+    pthread_cond_destroy(&s->work);
+    pthread_cond_destroy(&s->idle);
+
+    PDC_free(s->w);
+    PDC_free(s);
+}
+
+int sched_add(SCHED *s, SESSION *S, void (*frame)(SESSION *, void *),
+              void *arg)
+{
+    struct _sched_ent *e;
+
+    PDC_LOG(("sched_add() - called\n"));
+
+    if (!s || !S || S->sched)
+        return ERR;
+
+    if (!(e = PDC_calloc(1, sizeof(struct _sched_ent))))
+        return ERR;
+
+    e->S = S;
+    e->frame = frame;
+    e->arg = arg;
+    e->state = ENT_IDLE;
+
+    pthread_mutex_lock(&s->lock);
+
+    e->home = s->w + s->next_home;
+    s->next_home = (s->next_home + 1) % s->nworkers;
+
+    e->next_all = s->all;
+    if (s->all)
+        s->all->prev_all = e;
+    s->all = e;
+
+    pthread_mutex_unlock(&s->lock);
+
+    S->sched = e;
+
+    return OK;
+}
+
+int sched_remove(SCHED *s, SESSION *S)
+{
+    struct _sched_ent *e;
+    struct _sched_worker *w;
+    bool queued;
+
+    PDC_LOG(("sched_remove() - called\n"));
+
+    if (!s || !S || !(e = S->sched) || e->home->s != s)
+        return ERR;
+
+    w = e->home;
+
+    pthread_mutex_lock(&w->lock);
+
+    e->removing = TRUE;
+
+    while (e->state == ENT_RUNNING || e->state == ENT_AGAIN)
+        pthread_cond_wait(&w->done, &w->lock);
+
+    /* A queued entry may already be claimed by a worker, so it can't
+       be pulled out here; the worker that dequeues it frees it. */
+
+    queued = (e->state == ENT_QUEUED);
+
+    if (queued)
+    {
+        e->state = ENT_DEAD;
+        e->S = NULL;            /* the session may go before the entry */
+    }
+
+    pthread_mutex_unlock(&w->lock);
+
+    S->sched = NULL;
+
+    if (!queued)
+    {
+        pthread_mutex_lock(&s->lock);
+        _unlink_all(s, e);
+        pthread_mutex_unlock(&s->lock);
+
+        PDC_free(e);
+    }
+
+    return OK;
+}
+
+int sched_post(SCHED *s, SESSION *S)
+{
+    struct _sched_ent *e;
+    struct _sched_worker *w;
+    bool wake = FALSE;
+
+    PDC_LOG(("sched_post() - called\n"));
+
+    if (!s || !S || !(e = S->sched) || e->home->s != s)
+        return ERR;
+
+    w = e->home;
+
+    pthread_mutex_lock(&w->lock);
+
+    if (e->state == ENT_IDLE)
+    {
+        _enqueue(w, e);
+        wake = TRUE;
+    }
+    else if (e->state == ENT_RUNNING)
+        e->state = ENT_AGAIN;
+
+    pthread_mutex_unlock(&w->lock);
+
+    if (wake)
+        _wake(s);
+
+    return OK;
+}
+
+int sched_drain(SCHED *s)
+{
+    PDC_LOG(("sched_drain() - called\n"));
+
+    if (!s)
+        return ERR;
+
+    pthread_mutex_lock(&s->lock);
+
+    while (s->pending || s->running)
+        pthread_cond_wait(&s->idle, &s->lock);
+
+    pthread_mutex_unlock(&s->lock);
+
+    return OK;
+}
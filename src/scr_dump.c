@@ -58,7 +58,7 @@ RCSID("$Id: scr_dump.c,v 1.30 2008/07/13 16:08:18 wmcbrine Exp $")
 #include <stdlib.h>
 #include <string.h>
 
-#define DUMPVER 1   /* Should be updated whenever the WINDOW struct is
+#define DUMPVER 2   /* Should be updated whenever the WINDOW struct is
                        changed */
 
 int putwin(SESSION *S, WINDOW *win, FILE *filep)
@@ -96,7 +96,10 @@ WINDOW *getwin(SESSION *S, FILE *filep)
 
     PDC_LOG(("getwin() - called\n"));
 
-    if ( !(win = PDC_malloc(sizeof(WINDOW))) )
+    if (!S || PDC_mem_full(S))
+        return (WINDOW *)NULL;
+
+    if ( !(win = PDC_smalloc(S, sizeof(WINDOW))) )
         return (WINDOW *)NULL;
 
     /* check for the marker, and load the WINDOW struct */
@@ -104,35 +107,42 @@ WINDOW *getwin(SESSION *S, FILE *filep)
     if (!filep || !fread(marker, 4, 1, filep) || strncmp(marker, "PDC", 3)
         || marker[3] != DUMPVER || !fread(win, sizeof(WINDOW), 1, filep))
     {
-        PDC_free(win);
+        PDC_sfree(S, win);
         return (WINDOW *)NULL;
     }
 
+    /* a ring pad or vpad comes back as a plain window: its lines are
+       read in order, and the dataset of a vpad is not saved */
+
+    win->_flags &= ~(_RINGPAD|_VPAD);
+    win->_ringhead = 0;
+    win->_vpad = NULL;
+
     nlines = win->_maxy;
     ncols = win->_maxx;
 
     /* allocate the line pointer array */
 
-    if ( !(win->_y = PDC_malloc(nlines * sizeof(chtype *))) )
+    if ( !(win->_y = PDC_smalloc(S, nlines * sizeof(chtype *))) )
     {
-        PDC_free(win);
+        PDC_sfree(S, win);
         return (WINDOW *)NULL;
     }
 
     /* allocate the minchng and maxchng arrays */
 
-    if ( !(win->_firstch = PDC_malloc(nlines * sizeof(int))) )
+    if ( !(win->_firstch = PDC_smalloc(S, nlines * sizeof(int))) )
     {
-        PDC_free(win->_y);
-        PDC_free(win);
+        PDC_sfree(S, win->_y);
+        PDC_sfree(S, win);
         return (WINDOW *)NULL;
     }
 
-    if ( !(win->_lastch = PDC_malloc(nlines * sizeof(int))) )
+    if ( !(win->_lastch = PDC_smalloc(S, nlines * sizeof(int))) )
     {
-        PDC_free(win->_firstch);
-        PDC_free(win->_y);
-        PDC_free(win);
+        PDC_sfree(S, win->_firstch);
+        PDC_sfree(S, win->_y);
+        PDC_sfree(S, win);
         return (WINDOW *)NULL;
     }
 
@@ -152,6 +162,8 @@ WINDOW *getwin(SESSION *S, FILE *filep)
         }
     }
 
+    S->stats.cells_written += (unsigned long)nlines * ncols;
+
     touchwin(S, win);
 
     return win;
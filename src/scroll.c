@@ -23,7 +23,9 @@ RCSID("$Id: scroll.c,v 1.36 2008/07/13 16:08:18 wmcbrine Exp $")
 
         For these functions to work, scrolling must be enabled via
         scrollok(). Note also that scrolling is not allowed if the
-        supplied window is a pad.
+        supplied window is a pad -- except for a ring pad (see
+        newringpad()), where scrolling the whole pad up costs the same
+        however many lines it has.
 
   Return Value:
         All functions return OK on success and ERR on error.
@@ -42,9 +44,21 @@ int wscrl(SESSION *S, WINDOW *win, int n)
 
     /* Check if window scrolls. Valid for window AND pad */
 
-    if (!S || !win || !win->_scroll || !n)
+    if (!S || !win || !win->_scroll || !n || (win->_flags & _VPAD))
         return ERR;
 
+    /* a ring pad scrolls up by recycling its oldest lines */
+
+    if ((win->_flags & _RINGPAD) && n > 0 && !win->_tmarg &&
+        win->_bmarg == win->_maxy - 1)
+    {
+        while (n--)
+            PDC_ring_advance(S, win);
+
+        PDC_sync(S, win);
+        return OK;
+    }
+
     blank = win->_bkgd;
 
     if (n > 0)
@@ -75,6 +89,9 @@ int wscrl(SESSION *S, WINDOW *win, int n)
 
         for (i = 0; i < win->_maxx; i++)
             *temp++ = blank;
+
+        S->stats.cells_written += (unsigned long)win->_maxx *
+                                  ((end - start) * dir + 1);
     }
 
     touchline(S, win, win->_tmarg, win->_bmarg - win->_tmarg + 1);
@@ -139,7 +139,7 @@ int slk_init(SESSION *S, int fmt)
 
     S->slk_label_fmt = fmt;
 
-    S->slk = PDC_calloc(S->slk_labels, sizeof(struct SLK));
+    S->slk = PDC_scalloc(S, S->slk_labels, sizeof(struct SLK));
 
     if (!S->slk)
         S->slk_labels = 0;
@@ -551,7 +551,7 @@ void PDC_slk_free(SESSION *S)
             S->SP->slk_winptr = (WINDOW *)NULL;
         }
 
-        PDC_free(S->slk);
+        PDC_sfree(S, S->slk);
         S->slk = (struct SLK *)NULL;
 
         S->slk_label_length = 0;
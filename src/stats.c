@@ -0,0 +1,201 @@
+/* Public Domain Curses */
+
+#include "curspriv.h"
+
+RCSID("$Id: stats.c,v 1.1 $")
+
+/*man-start**************************************************************
+
+  Name:                                                         stats
+
+  Synopsis:
+        int session_stats(SESSION *S, SESSION_STATS *out);
+        int session_stats_dump(SESSION *S, FILE *fp);
+        int session_stats_reset(SESSION *S);
+        unsigned long session_latency(SESSION *S, int percent);
+
+  Description:
+        Each session counts the work done for it, from initscr() or the
+        last session_stats_reset(): the cells written to its windows
+        by any call, the cells wnoutrefresh() compared against curscr
+        and copied to it, the rows and cells doupdate() sent to the
+        terminal, the times the panel map was worked out again, and
+        the blocks and bytes allocated, as session_memory() counts
+        them. The lines moved by a scroll, an insertion or a deletion
+        count as written; waddch(), waddchnstr() and copywin() count
+        only the cells they change. The counters are always on, and
+        cost an addition each. doupdate() is also
+        timed, by the monotonic clock, and its calls kept in a
+        histogram of SESSION_STATS .update_time[]: [0] counts those
+        under a microsecond, each [i] after it those under 2^i
+        microseconds, and the last all the slower ones.
+
+        Each key and mouse event is stamped when it comes in: when it
+        is pushed with keyring_push(), when its bytes reach the escape
+        sequence decoder, or else when wgetch() reads it from the
+        platform. The first doupdate() to finish after wgetch() has
+        read input then counts, in .input_latency[], the time from the
+        arrival of the oldest of it to its own end; that is, the time
+        a user waited to see a key echoed or acted on. A doupdate()
+        that gives way to typeahead leaves it to the next one.
+
+        session_stats() copies the counters of S into out.
+        session_stats_dump() writes them to fp as text, one to a line.
+        session_stats_reset() sets them to 0.
+
+        session_latency() returns a bound on the input latency of
+        percent per cent of the updates counted: the top of the first
+        bucket in which that many are reached, in microseconds.
+
+  Return Value:
+        session_latency() returns 0 if there is nothing counted, and
+        ULONG_MAX if the bound falls in the last bucket. The other
+        functions return ERR if S (or out, or fp) is NULL, and OK
+        otherwise.
+
+  Portability                                X/Open    BSD    SYS V
+        session_stats                           -       -       -
+        session_stats_dump                      -       -       -
+        session_stats_reset                     -       -       -
+        session_latency                         -       -       -
+
+**man-end****************************************************************/
+
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+
+static void _histogram(FILE *fp, const char *name, const unsigned long *h)
+{
+    int i;
+
+    /* only the buckets in use */
+
+    for (i = 0; i < PDC_STATS_BUCKETS; i++)
+        if (h[i])
+        {
+            if (i < PDC_STATS_BUCKETS - 1)
+                fprintf(fp, "%s < %7lu us %lu\n", name, 1UL << i, h[i]);
+            else
+                fprintf(fp, "%s >= %6lu us %lu\n", name, 1UL << (i - 1),
+                        h[i]);
+        }
+}
+
+int session_stats(SESSION *S, SESSION_STATS *out)
+{
+    PDC_LOG(("session_stats() - called\n"));
+
+    if (!S || !out)
+        return ERR;
+
+    *out = S->stats;
+
+    return OK;
+}
+
+int session_stats_dump(SESSION *S, FILE *fp)
+{
+    SESSION_STATS *st;
+
+    PDC_LOG(("session_stats_dump() - called\n"));
+
+    if (!S || !fp)
+        return ERR;
+
+    st = &S->stats;
+
+    fprintf(fp, "cells written     %lu\n", st->cells_written);
+    fprintf(fp, "refreshes         %lu\n", st->refreshes);
+    fprintf(fp, "cells compared    %lu\n", st->cells_compared);
+    fprintf(fp, "cells copied      %lu\n", st->cells_copied);
+    fprintf(fp, "updates           %lu\n", st->updates);
+    fprintf(fp, "rows sent         %lu\n", st->rows_sent);
+    fprintf(fp, "cells sent        %lu\n", st->cells_sent);
+    fprintf(fp, "panel maps        %lu\n", st->panel_maps);
+    fprintf(fp, "allocations       %lu\n", st->allocs);
+    fprintf(fp, "bytes allocated   %lu\n", st->alloc_bytes);
+
+    _histogram(fp, "update ", st->update_time);
+    _histogram(fp, "latency", st->input_latency);
+
+    return OK;
+}
+
+int session_stats_reset(SESSION *S)
+{
+    PDC_LOG(("session_stats_reset() - called\n"));
+
+    if (!S)
+        return ERR;
+
+    memset(&S->stats, 0, sizeof(SESSION_STATS));
+
+    return OK;
+}
+
+unsigned long session_latency(SESSION *S, int percent)
+{
+    unsigned long total = 0, acc = 0;
+    int i;
+
+    PDC_LOG(("session_latency() - called: percent %d\n", percent));
+
+    if (!S)
+        return 0;
+
+    for (i = 0; i < PDC_STATS_BUCKETS; i++)
+        total += S->stats.input_latency[i];
+
+    if (!total)
+        return 0;
+
+    for (i = 0; i < PDC_STATS_BUCKETS - 1; i++)
+    {
+        acc += S->stats.input_latency[i];
+
+        if (acc * 100 >= total * percent)
+            return 1UL << i;
+    }
+
+    return ULONG_MAX;
+}
+
+/* Microseconds by the monotonic clock, for timing doupdate() and
+   input */
+
+unsigned long PDC_stats_usec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (unsigned long)ts.tv_sec * 1000000UL + ts.tv_nsec / 1000;
+}
+
+static int _bucket(unsigned long us)
+{
+    int i;
+
+    for (i = 0; us && i < PDC_STATS_BUCKETS - 1; i++)
+        us >>= 1;
+
+    return i;
+}
+
+/* Count a doupdate() begun at start; if it finished the screen, it
+   has served the input read before it */
+
+void PDC_stats_update(SESSION *S, unsigned long start, bool done)
+{
+    unsigned long now = PDC_stats_usec();
+
+    S->stats.updates++;
+    S->stats.update_time[_bucket(now - start)]++;
+
+    if (done && S->input_since)
+    {
+        S->stats.input_latency[_bucket(now - S->input_since)]++;
+        S->input_since = 0;
+    }
+}
@@ -0,0 +1,185 @@
+/* Public Domain Curses */
+
+#include "curspriv.h"
+
+RCSID("$Id: timer.c,v 1.1 $")
+
+/*man-start**************************************************************
+
+  Name:                                                         timer
+
+  Synopsis:
+        int add_timer(SESSION *S, int ms,
+                      int (*cb)(SESSION *, void *), void *arg);
+        int del_timer(SESSION *S, int id);
+
+  Description:
+        add_timer() sets a timer to call cb(S, arg) in ms milliseconds.
+        Timers run from within wgetch() (and wgetch_r(), wgetnstr() and
+        the rest), which sleeps until the first of its own timeout and
+        the timers is due, so an application that only redraws a clock
+        needs no halfdelay() or timeout() to wake it. A callback
+        returns the number of milliseconds until it should run again,
+        measured from when it was due, or 0 or less to end the timer.
+
+        Callbacks should draw with wnoutrefresh(), or update_panels().
+        When all the timers that are due have run, wgetch() updates the
+        screen once, leaving the cursor in the window it reads from.
+        A callback may add or delete timers, but not delete its own; it
+        returns 0 instead.
+
+        del_timer() deletes the timer with the given id.
+
+        When S is run by a reactor, reactor_run() also wakes for the
+        timers of S, and draws the frame after them.
+
+  Return Value:
+        add_timer() returns the id of the timer, which is greater than
+        0, or ERR. del_timer() returns ERR if there is no such timer,
+        and OK otherwise.
+
+  Portability                                X/Open    BSD    SYS V
+        add_timer                               -       -       -
+        del_timer                               -       -       -
+
+**man-end****************************************************************/
+
+struct _timer
+{
+    int id;
+    unsigned long due;          /* PDC_get_clock() when it runs */
+    int (*cb)(SESSION *, void *);
+    void *arg;
+    struct _timer *next;
+};
+
+/* the list is kept in order of due time */
+
+static void _insert(SESSION *S, struct _timer *t)
+{
+    struct _timer **p = &S->timers;
+
+    while (*p && (long)((*p)->due - t->due) <= 0)
+        p = &(*p)->next;
+
+    t->next = *p;
+    *p = t;
+}
+
+int add_timer(SESSION *S, int ms, int (*cb)(SESSION *, void *), void *arg)
+{
+    struct _timer *t;
+
+    PDC_LOG(("add_timer() - called: ms %d\n", ms));
+
+    if (!S || !cb || ms < 0)
+        return ERR;
+
+    if (!(t = PDC_smalloc(S, sizeof(struct _timer))))
+        return ERR;
+
+    if (++S->timer_id <= 0)     /* wrapped */
+        S->timer_id = 1;
+
+    t->id = S->timer_id;
+    t->due = PDC_get_clock(S) + ms;
+    t->cb = cb;
+    t->arg = arg;
+
+    _insert(S, t);
+
+    return t->id;
+}
+
+int del_timer(SESSION *S, int id)
+{
+    struct _timer **p, *t;
+
+    PDC_LOG(("del_timer() - called: id %d\n", id));
+
+    if (!S)
+        return ERR;
+
+    for (p = &S->timers; (t = *p) != NULL; p = &t->next)
+        if (t->id == id)
+        {
+            *p = t->next;
+            PDC_sfree(S, t);
+            return OK;
+        }
+
+    return ERR;
+}
+
+/* Bound a wait of ms milliseconds (-1 for no limit) by the next timer */
+
+int PDC_timer_wait(SESSION *S, int ms)
+{
+    long left;
+
+    if (!S || !S->timers)
+        return ms;
+
+    left = (long)(S->timers->due - PDC_get_clock(S));
+
+    if (left < 0)
+        left = 0;
+
+    return (ms < 0 || left < ms) ? (int)left : ms;
+}
+
+/* Run the timers that are due. Returns TRUE if any ran. */
+
+bool PDC_timer_run(SESSION *S)
+{
+    unsigned long now;
+    bool ran = FALSE;
+
+    if (!S || !S->timers)
+        return FALSE;
+
+    now = PDC_get_clock(S);
+
+    /* a timer run again is due after now, so the loop ends */
+
+    while (S->timers && (long)(S->timers->due - now) <= 0)
+    {
+        struct _timer *t = S->timers;
+        int next;
+
+        S->timers = t->next;
+        ran = TRUE;
+
+        next = (*t->cb)(S, t->arg);
+
+        if (next > 0)
+        {
+            /* keep to the period, unless it fell behind */
+
+            t->due += next;
+
+            if ((long)(t->due - now) <= 0)
+                t->due = now + next;
+
+            _insert(S, t);
+        }
+        else
+            PDC_sfree(S, t);
+    }
+
+    return ran;
+}
+
+void PDC_timer_free(SESSION *S)
+{
+    struct _timer *t;
+
+    if (!S)
+        return;
+
+    while ((t = S->timers) != NULL)
+    {
+        S->timers = t->next;
+        PDC_sfree(S, t);
+    }
+}
@@ -0,0 +1,272 @@
+/* Public Domain Curses */
+
+#include "curspriv.h"
+
+RCSID("$Id: trace.c,v 1.1 $")
+
+/*man-start**************************************************************
+
+  Name:                                                         trace
+
+  Synopsis:
+        int trace_start(SESSION *S, int records);
+        int trace_stop(SESSION *S);
+        int trace_dump(SESSION *S, FILE *fp);
+        int trace_decode(FILE *in, FILE *out);
+
+  Description:
+        A session can keep a trace of its main calls in a ring of
+        fixed-size binary records, each holding the call, the window,
+        a position, an argument and the time in microseconds. Writing
+        one costs a few stores, with no formatting or I/O, so a
+        session can be traced in production; when tracing is off, a
+        trace point is a single test. The calls traced are wmove(),
+        waddnstr(), waddchnstr(), werase(), wnoutrefresh() (with the
+        cells it copied), doupdate() (its start, and its end with the
+        rows sent), update_panels(), the keys returned by wgetch() and
+        wgetch_r(), wgetch_batch() (with the keys it read) and napms().
+
+        trace_start() gives S a ring of the given number of records,
+        rounded up to a power of two, and turns tracing on. The ring
+        holds the latest records; older ones are overwritten.
+        trace_stop() turns tracing off, keeping the ring to be dumped.
+        Both must be called from the thread that runs S.
+
+        trace_dump() writes the records in the ring, oldest first, to
+        fp in binary. It takes no locks, and may be called from
+        another thread while S runs, but not with trace_start() or
+        delscreen(); records that were overwritten while it read them
+        are left out.
+
+        trace_decode() reads a dump from in, which may have come from
+        another process on the same machine type, and writes it to out
+        as a timeline of one line per record: the time from the first
+        record and from the one before, in microseconds, then the call,
+        window, position and argument.
+
+  Return Value:
+        trace_dump() and trace_decode() return the number of records
+        written, or ERR. The other functions return OK or ERR.
+
+  Portability                                X/Open    BSD    SYS V
+        trace_start                             -       -       -
+        trace_stop                              -       -       -
+        trace_dump                              -       -       -
+        trace_decode                            -       -       -
+
+**man-end****************************************************************/
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#define PDC_TRACE_MAGIC "PDCTRC1"
+
+struct _trace_rec
+{
+    uint64_t time;              /* PDC_stats_usec() */
+    uint64_t win;
+    int32_t arg;
+    uint16_t func;              /* PDC_TR_* */
+    int16_t y, x;
+    uint16_t spare;
+};
+
+struct _trace_head              /* at the start of a dump */
+{
+    char magic[8];
+    uint32_t recsize;
+    uint32_t count;
+};
+
+struct _trace
+{
+    atomic_ulong head;          /* records written so far */
+    unsigned mask;              /* size - 1 */
+    struct _trace_rec rec[1];
+};
+
+static const char *_names[] =
+{
+    "?", "wmove", "waddnstr", "waddchnstr", "werase", "wnoutrefresh",
+    "doupdate", "doupdate end", "update_panels", "wgetch",
+    "wgetch_batch", "napms"
+};
+
+int trace_start(SESSION *S, int records)
+{
+    struct _trace *t;
+    unsigned size = 1;
+
+    PDC_LOG(("trace_start() - called: records %d\n", records));
+
+    if (!S || records < 1)
+        return ERR;
+
+    while (size < (unsigned)records)
+        size <<= 1;
+
+    if (!(t = S->trace) || t->mask != size - 1)
+    {
+        t = PDC_smalloc(S, sizeof(struct _trace) +
+                       (size - 1) * sizeof(struct _trace_rec));
+        if (!t)
+            return ERR;
+
+        t->mask = size - 1;
+
+        PDC_trace_free(S);
+        S->trace = t;
+    }
+
+    atomic_init(&t->head, 0);
+    S->trace_on = TRUE;
+
+    return OK;
+}
+
+int trace_stop(SESSION *S)
+{
+    PDC_LOG(("trace_stop() - called\n"));
+
+    if (!S)
+        return ERR;
+
+    S->trace_on = FALSE;
+
+    return OK;
+}
+
+int trace_dump(SESSION *S, FILE *fp)
+{
+    struct _trace *t;
+    struct _trace_head h;
+    struct _trace_rec *buf;
+    unsigned long start, last, i;
+    long skip;
+
+    PDC_LOG(("trace_dump() - called\n"));
+
+    if (!S || !fp || !(t = S->trace))
+        return ERR;
+
+    if (!(buf = PDC_malloc((t->mask + 1) * sizeof(struct _trace_rec))))
+        return ERR;
+
+    /* copy, then see what the writer may have overwritten meanwhile:
+       with the head at i, it may be writing record i, in the slot of
+       record i - size, so that one and all before it are gone */
+
+    last = atomic_load_explicit(&t->head, memory_order_acquire);
+    start = (last > t->mask) ? last - t->mask - 1 : 0;
+
+    for (i = start; i != last; i++)
+        buf[i - start] = t->rec[i & t->mask];
+
+    atomic_thread_fence(memory_order_acquire);
+
+    i = atomic_load_explicit(&t->head, memory_order_relaxed);
+
+    skip = (long)(i - t->mask) - (long)start;
+
+    if (skip < 0)
+        skip = 0;
+    else if (skip > (long)(last - start))
+        skip = last - start;
+
+    memset(&h, 0, sizeof(h));
+    strcpy(h.magic, PDC_TRACE_MAGIC);
+    h.recsize = sizeof(struct _trace_rec);
+    h.count = last - start - skip;
+
+    if (fwrite(&h, sizeof(h), 1, fp) != 1 ||
+        fwrite(buf + skip, sizeof(struct _trace_rec), h.count,
+               fp) != h.count)
+    {
+        PDC_free(buf);
+        return ERR;
+    }
+
+    PDC_free(buf);
+
+    return (int)h.count;
+}
+
+int trace_decode(FILE *in, FILE *out)
+{
+    struct _trace_head h;
+    struct _trace_rec rec;
+    uint64_t start = 0, prev = 0;
+    unsigned n;
+
+    PDC_LOG(("trace_decode() - called\n"));
+
+    if (!in || !out)
+        return ERR;
+
+    if (fread(&h, sizeof(h), 1, in) != 1 ||
+        strcmp(h.magic, PDC_TRACE_MAGIC) ||
+        h.recsize != sizeof(struct _trace_rec))
+        return ERR;
+
+    fprintf(out, "%12s %10s  %-14s %-18s %5s %5s  %s\n", "time(us)",
+            "delta", "call", "window", "y", "x", "arg");
+
+    for (n = 0; n < h.count; n++)
+    {
+        if (fread(&rec, sizeof(rec), 1, in) != 1)
+            return ERR;
+
+        if (!n)
+            start = prev = rec.time;
+
+        fprintf(out, "%12llu %10llu  %-14s %#-18llx %5d %5d  %ld\n",
+                (unsigned long long)(rec.time - start),
+                (unsigned long long)(rec.time - prev),
+                rec.func < sizeof(_names) / sizeof(_names[0]) ?
+                _names[rec.func] : "?", (unsigned long long)rec.win,
+                rec.y, rec.x, (long)rec.arg);
+
+        prev = rec.time;
+    }
+
+    return (int)n;
+}
+
+/* Write a record; called through PDC_TRACE() when tracing is on. Only
+   the thread running S calls it, so the head needs no atomic add. As
+   in a seqlock, the fence keeps the writes to the slot from being seen
+   before the head that last published it, so trace_dump() can't copy
+   a half-written record i + 1 and then read a head of i. */
+
+void PDC_trace(SESSION *S, int func, const WINDOW *win, int y, int x,
+               long arg)
+{
+    struct _trace *t = S->trace;
+    unsigned long head = atomic_load_explicit(&t->head,
+                                              memory_order_relaxed);
+    struct _trace_rec *rec = &t->rec[head & t->mask];
+
+    atomic_thread_fence(memory_order_release);
+
+    rec->time = PDC_stats_usec();
+    rec->win = (uintptr_t)win;
+    rec->arg = (int32_t)arg;
+    rec->func = (uint16_t)func;
+    rec->y = (int16_t)y;
+    rec->x = (int16_t)x;
+    rec->spare = 0;
+
+    atomic_store_explicit(&t->head, head + 1, memory_order_release);
+}
+
+void PDC_trace_free(SESSION *S)
+{
+    if (!S || !S->trace)
+        return;
+
+    S->trace_on = FALSE;
+
+    PDC_sfree(S, S->trace);
+    S->trace = NULL;
+}
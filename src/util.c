@@ -10,6 +10,7 @@ RCSID("$Id: util.c,v 1.71 2008/07/13 16:08:18 wmcbrine Exp $")
 
   Synopsis:
         char *unctrl(chtype c);
+        char *unctrl_r(chtype c, char *buf);
         void filter(void);
         void use_env(bool x);
         int delay_output(int ms);
@@ -28,7 +29,10 @@ RCSID("$Id: util.c,v 1.71 2008/07/13 16:08:18 wmcbrine Exp $")
         unctrl() expands the text portion of the chtype c into a
         printable string. Control characters are changed to the "^X"
         notation; others are passed through. wunctrl() is the wide-
-        character version of the function.
+        character version of the function. The string returned by
+        unctrl() belongs to the session and is overwritten by the next
+        call; unctrl_r() writes it instead to buf, which must hold at
+        least three chars, and returns buf.
 
         filter() and use_env() are no-ops in PDCurses.
 
@@ -62,6 +66,7 @@ RCSID("$Id: util.c,v 1.71 2008/07/13 16:08:18 wmcbrine Exp $")
 
   Portability                                X/Open    BSD    SYS V
         unctrl                                  Y       Y       Y
+        unctrl_r                                -       -       -
         filter                                  Y       -      3.0
         use_env                                 Y       -      4.0
         delay_output                            Y       Y       Y
@@ -75,13 +80,14 @@ RCSID("$Id: util.c,v 1.71 2008/07/13 16:08:18 wmcbrine Exp $")
 **man-end****************************************************************/
 
 
-char *unctrl(chtype c)
+char *unctrl_r(chtype c, char *strbuf)
 {
-    static char strbuf[3] = {0, 0, 0};
-
     chtype ic;
 
-    PDC_LOG(("unctrl() - called\n"));
+    PDC_LOG(("unctrl_r() - called\n"));
+
+    if (!strbuf)
+        return NULL;
 
     ic = c & A_CHARTEXT;
 
@@ -99,9 +105,21 @@ char *unctrl(chtype c)
     else                    /* other control */
         strbuf[1] = (char)(ic + '@');
 
+    strbuf[2] = '\0';
+
     return strbuf;
 }
 
+char *unctrl(SESSION *S, chtype c)
+{
+    PDC_LOG(("unctrl() - called\n"));
+
+    if (!S)
+        return NULL;
+
+    return unctrl_r(c, S->unctrl_buf);
+}
+
 void filter(SESSION *S)
 {
     PDC_LOG(("filter() - called\n"));
@@ -129,6 +147,16 @@ int COLS(SESSION *S)
     return S->COLS;
 }
 
+int COLORS(SESSION *S)
+{
+    return S->COLORS;
+}
+
+int COLOR_PAIRS(SESSION *S)
+{
+    return S->COLOR_PAIRS;
+}
+
 WINDOW* stdscr(SESSION *S)
 {
     return S->stdscr;
@@ -79,7 +79,8 @@ RCSID("$Id: window.c,v 1.62 2008/07/13 16:08:18 wmcbrine Exp $")
         its parent's windows have been touched.
 
         resize_window() allows the user to resize an existing window. It
-        returns the pointer to the new window, or NULL on failure.
+        returns the pointer to the new window, or NULL on failure. Ring
+        pads and virtual pads can't be resized.
 
         wresize() is an ncurses-compatible wrapper for resize_window().
         Note that, unlike ncurses, it will NOT process any subwindows of
@@ -138,33 +139,36 @@ WINDOW *PDC_makenew(SESSION *S, int nlines, int ncols, int begy, int begx)
     PDC_LOG(("PDC_makenew() - called: lines %d cols %d begy %d begx %d\n",
              nlines, ncols, begy, begx));
 
+    if (PDC_mem_full(S))
+        return (WINDOW *)NULL;
+
     /* allocate the window structure itself */
 
-    if ((win = PDC_calloc(1, sizeof(WINDOW))) == (WINDOW *)NULL)
+    if ((win = PDC_scalloc(S, 1, sizeof(WINDOW))) == (WINDOW *)NULL)
         return win;
 
     /* allocate the line pointer array */
 
-    if ((win->_y = PDC_malloc(nlines * sizeof(chtype *))) == NULL)
+    if ((win->_y = PDC_smalloc(S, nlines * sizeof(chtype *))) == NULL)
     {
-        PDC_free(win);
+        PDC_sfree(S, win);
         return (WINDOW *)NULL;
     }
 
     /* allocate the minchng and maxchng arrays */
 
-    if ((win->_firstch = PDC_malloc(nlines * sizeof(short))) == NULL)
+    if ((win->_firstch = PDC_smalloc(S, nlines * sizeof(short))) == NULL)
     {
-        PDC_free(win->_y);
-        PDC_free(win);
+        PDC_sfree(S, win->_y);
+        PDC_sfree(S, win);
         return (WINDOW *)NULL;
     }
 
-    if ((win->_lastch = PDC_malloc(nlines * sizeof(short))) == NULL)
+    if ((win->_lastch = PDC_smalloc(S, nlines * sizeof(short))) == NULL)
     {
-        PDC_free(win->_firstch);
-        PDC_free(win->_y);
-        PDC_free(win);
+        PDC_sfree(S, win->_firstch);
+        PDC_sfree(S, win->_y);
+        PDC_sfree(S, win);
         return (WINDOW *)NULL;
     }
 
@@ -178,6 +182,7 @@ WINDOW *PDC_makenew(SESSION *S, int nlines, int ncols, int begy, int begx)
     win->_clear = (bool) ((nlines == S->LINES) && (ncols == S->COLS));
     win->_bmarg = nlines - 1;
     win->_parx = win->_pary = -1;
+    win->_padx = win->_pady = -1;
 
     /* init to say window all changed */
 
@@ -201,17 +206,17 @@ WINDOW *PDC_makelines(SESSION *S, WINDOW *win)
 
     for (i = 0; i < nlines; i++)
     {
-        if ((win->_y[i] = PDC_malloc(ncols * sizeof(chtype))) == NULL)
+        if ((win->_y[i] = PDC_smalloc(S, ncols * sizeof(chtype))) == NULL)
         {
             /* if error, free all the data */
 
             for (j = 0; j < i; j++)
-                PDC_free(win->_y[j]);
+                PDC_sfree(S, win->_y[j]);
 
-            PDC_free(win->_firstch);
-            PDC_free(win->_lastch);
-            PDC_free(win->_y);
-            PDC_free(win);
+            PDC_sfree(S, win->_firstch);
+            PDC_sfree(S, win->_lastch);
+            PDC_sfree(S, win->_y);
+            PDC_sfree(S, win);
 
             return (WINDOW *)NULL;
         }
@@ -269,12 +274,25 @@ int delwin(SESSION *S, WINDOW *win)
     if (!(win->_flags & (_SUBWIN|_SUBPAD)))
         for (i = 0; i < win->_maxy && win->_y[i]; i++)
             if (win->_y[i])
-                PDC_free(win->_y[i]);
+                PDC_sfree(S, win->_y[i]);
+
+    /* a ring pad's line arrays are viewed from an offset */
 
-    PDC_free(win->_firstch);
-    PDC_free(win->_lastch);
-    PDC_free(win->_y);
-    PDC_free(win);
+    if (win->_flags & _RINGPAD)
+    {
+        win->_y -= win->_ringhead;
+        win->_firstch -= win->_ringhead;
+        win->_lastch -= win->_ringhead;
+    }
+
+    PDC_sfree(S, win->_firstch);
+    PDC_sfree(S, win->_lastch);
+    PDC_sfree(S, win->_y);
+
+    if (win->_vpad)
+        PDC_sfree(S, win->_vpad);
+
+    PDC_sfree(S, win);
 
     return OK;
 }
@@ -304,9 +322,12 @@ WINDOW *subwin(SESSION *S, WINDOW *orig, int nlines, int ncols, int begy, int be
     PDC_LOG(("subwin() - called: lines %d cols %d begy %d begx %d\n",
              nlines, ncols, begy, begx));
 
-    /* make sure window fits inside the original one */
+    /* make sure window fits inside the original one; the lines of a
+       ring pad move, and those of a virtual pad are a cache, so
+       neither can be shared, as with subpad() */
 
-    if (!orig || (begy < orig->_begy) || (begx < orig->_begx) ||
+    if (!orig || (orig->_flags & (_RINGPAD|_VPAD)) ||
+        (begy < orig->_begy) || (begx < orig->_begx) ||
         (begy + nlines) > (orig->_begy + orig->_maxy) ||
         (begx + ncols) > (orig->_begx + orig->_maxx))
         return (WINDOW *)NULL;
@@ -420,7 +441,7 @@ WINDOW *dupwin(SESSION *S, WINDOW *win)
     new->_pary = win->_pary;
     new->_parent = win->_parent;
     new->_bkgd = win->_bkgd;
-    new->_flags = win->_flags;
+    new->_flags = win->_flags & ~(_RINGPAD|_VPAD);
 
     return new;
 }
@@ -433,7 +454,7 @@ WINDOW *resize_window(SESSION *S, WINDOW *win, int nlines, int ncols)
     PDC_LOG(("resize_window() - called: nlines %d ncols %d\n",
              nlines, ncols));
 
-    if (!S || !win)
+    if (!S || !win || (win->_flags & (_RINGPAD|_VPAD)))
         return (WINDOW *)NULL;
 
     if (win->_flags & _SUBPAD)
@@ -480,7 +501,7 @@ WINDOW *resize_window(SESSION *S, WINDOW *win, int nlines, int ncols)
 
         for (i = 0; i < win->_maxy && win->_y[i]; i++)
             if (win->_y[i])
-                PDC_free(win->_y[i]);
+                PDC_sfree(S, win->_y[i]);
     }
 
     new->_flags = win->_flags;
@@ -501,12 +522,12 @@ WINDOW *resize_window(SESSION *S, WINDOW *win, int nlines, int ncols)
     new->_curx = save_curx;
     new->_cury = save_cury;
 
-    PDC_free(win->_firstch);
-    PDC_free(win->_lastch);
-    PDC_free(win->_y);
+    PDC_sfree(S, win->_firstch);
+    PDC_sfree(S, win->_lastch);
+    PDC_sfree(S, win->_y);
 
     *win = *new;
-    PDC_free(new);
+    PDC_sfree(S, new);
 
     return win;
 }